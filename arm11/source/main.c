@@ -31,6 +31,7 @@
 #include "hw/nvram.h"
 
 #include "system/sys.h"
+#include "system/jobs.h"
 
 static const u8 brLvlTbl[] = {
 	0x10, 0x17, 0x1E, 0x25,
@@ -159,6 +160,13 @@ void PXI_RX_Handler(u32 __attribute__((unused)) irqn)
 			break;
 		}
 
+		case PXI_JOB_NOTIFY:
+		{
+			// jobs are run from the main loop, this only wakes it up
+			ret = 0;
+			break;
+		}
+
 		/* New CMD template:
 		case CMD_ID:
 		{
@@ -187,6 +195,10 @@ void __attribute__((noreturn)) MainLoop(void)
 	autoBr = true;
 	#endif
 
+	// shared memory isn't initialized, start with an empty job queue
+	SharedMemoryState.jobQueue.head = 0;
+	SharedMemoryState.jobQueue.tail = 0;
+
 	// configure interrupts
 	gicSetInterruptConfig(PXI_RX_INTERRUPT, BIT(0), GIC_PRIO2, PXI_RX_Handler);
 	gicSetInterruptConfig(MCU_INTERRUPT, BIT(0), GIC_PRIO1, MCU_HandleInterrupts);
@@ -200,9 +212,16 @@ void __attribute__((noreturn)) MainLoop(void)
 	// ARM9 won't try anything funny until this point
 	PXI_Barrier(PXI_BOOT_BARRIER);
 
-	// Process IRQs until the ARM9 tells us it's time to boot something else
+	// Process IRQs and offloaded jobs until the ARM9 tells us it's time to boot something else
 	do {
-		ARM_WFI();
+		// interrupts are masked while checking, so a job
+		// notification can't slip in right before the WFI
+		u32 irqstate = ARM_EnterCritical();
+		if (!JOB_Pending(&SharedMemoryState.jobQueue))
+			ARM_WFI();
+		ARM_LeaveCritical(irqstate);
+
+		JOB_RunQueue(&SharedMemoryState.jobQueue);
 	} while(!legacy_boot);
 
 	// Wait for the ARM9 to do its firmlaunch setup
@@ -0,0 +1,67 @@
+/*
+ *   This file is part of GodMode9
+ *   Copyright (C) 2019 Wolfvak
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 2 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <types.h>
+#include <arm.h>
+#include <shmem.h>
+
+#include "hw/i2c.h"
+#include "system/jobs.h"
+
+static u32 JOB_Run(SystemJob *job)
+{
+	switch(job->type) {
+		case JOB_NOP:
+			return 0;
+
+		case JOB_I2C_READ:
+		case JOB_I2C_WRITE:
+		{
+			bool ret;
+			u32 size = job->args[2];
+			if (size > JOB_DATA_SIZE)
+				return 0;
+
+			// the MCU and PXI handlers use the bus too, keep them out
+			u32 irqstate = ARM_EnterCritical();
+			if (job->type == JOB_I2C_READ)
+				ret = I2C_readRegBuf(job->args[0], job->args[1], job->data, size);
+			else
+				ret = I2C_writeRegBuf(job->args[0], job->args[1], job->data, size);
+			ARM_LeaveCritical(irqstate);
+			return ret;
+		}
+
+		default:
+			return 0xFFFFFFFF;
+	}
+}
+
+void JOB_RunQueue(SystemJobQueue *queue)
+{
+	u32 tail = queue->tail;
+
+	while(tail != queue->head) {
+		SystemJob *job = &queue->slot[tail % JOB_QUEUE_SLOTS];
+		job->result = JOB_Run(job);
+
+		// the result has to be visible before the slot is handed back
+		ARM_DSB();
+		queue->tail = ++tail;
+	}
+}
@@ -27,6 +27,22 @@ bool IsCharging() {
     return flags & (1<<4);
 }
 
+void GetPowerStatus(u32* battery, bool* is_charging) {
+    u8 level = 0;
+    u8 flags = 0;
+
+    // both reads go to the ARM11 in one batch
+    u32 t_level = I2C_queueReadRegBuf(I2C_DEV_MCU, 0x0B, 1);
+    u32 t_flags = I2C_queueReadRegBuf(I2C_DEV_MCU, 0x0F, 1);
+    if (t_level) I2C_waitReadRegBuf(t_level, &level, 1);
+    else I2C_readRegBuf(I2C_DEV_MCU, 0x0B, &level, 1);
+    if (t_flags) I2C_waitReadRegBuf(t_flags, &flags, 1);
+    else I2C_readRegBuf(I2C_DEV_MCU, 0x0F, &flags, 1);
+
+    if (battery) *battery = level;
+    if (is_charging) *is_charging = flags & (1<<4);
+}
+
 void Reboot() {
     I2C_writeReg(I2C_DEV_MCU, 0x22, 1 << 0); // poweroff LCD to prevent MCU hangs
     ARM_WbDC();
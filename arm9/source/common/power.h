@@ -9,5 +9,6 @@
 u32 SetScreenBrightness(int level);
 u32 GetBatteryPercent();
 bool IsCharging();
+void GetPowerStatus(u32* battery, bool* is_charging);
 void Reboot();
 void PowerOff();
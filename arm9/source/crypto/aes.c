@@ -1,6 +1,51 @@
 /* original version by megazig */
+#include <string.h>
 #include "aes.h"
 
+// keyslot state tracking, each key write gets a new, unique generation
+static uint32_t aeskey_gen_ctr = 0;
+static uint32_t aeskey_gen[0x40] = { 0 };
+
+void invalidate_aeskey(uint32_t keyslot)
+{
+    if (keyslot > 0x3F)
+        return;
+    aeskey_gen[keyslot] = ++aeskey_gen_ctr;
+}
+
+uint32_t aeskey_state(uint32_t keyslot)
+{
+    return (keyslot > 0x3F) ? 0 : aeskey_gen[keyslot];
+}
+
+// last keyY set through setup_aeskeyY_cached() per keyslot, valid while the generation matches
+static uint8_t aeskey_y_last[0x40][16];
+static uint32_t aeskey_y_gen[0x40] = { 0 };
+static uint32_t aeskey_y_loads = 0;
+static uint32_t aeskey_y_skipped = 0;
+
+void setup_aeskeyY_cached(uint8_t keyslot, const void* keyy)
+{
+    if ((keyslot <= 0x3F) && aeskey_y_gen[keyslot] && (aeskey_y_gen[keyslot] == aeskey_gen[keyslot]) &&
+        (memcmp(aeskey_y_last[keyslot], keyy, 16) == 0)) {
+        aeskey_y_skipped++;
+        return;
+    }
+
+    setup_aeskeyY(keyslot, keyy);
+    aeskey_y_loads++;
+    if (keyslot <= 0x3F) {
+        memcpy(aeskey_y_last[keyslot], keyy, 16);
+        aeskey_y_gen[keyslot] = aeskey_gen[keyslot];
+    }
+}
+
+void aeskey_cache_stats(uint32_t* loads, uint32_t* skipped)
+{
+    if (loads) *loads = aeskey_y_loads;
+    if (skipped) *skipped = aeskey_y_skipped;
+}
+
 // FIXME some things make assumptions about alignemnts!
 // setup_aeskey? and set_ctr do not anymore (c) d0k3
 void setup_aeskeyX(uint8_t keyslot, const void* keyx)
@@ -24,6 +69,7 @@ void setup_aeskeyX(uint8_t keyslot, const void* keyx)
             reg_aeskeyx[i] = _keyx[i];
         *REG_AESCNT = old_aescnt;
     }
+    invalidate_aeskey(keyslot);
 }
 
 void setup_aeskeyY(uint8_t keyslot, const void* keyy)
@@ -47,6 +93,7 @@ void setup_aeskeyY(uint8_t keyslot, const void* keyy)
             reg_aeskeyy[i] = _keyy[i];
         *REG_AESCNT = old_aescnt;
     }
+    invalidate_aeskey(keyslot);
 }
 
 void setup_aeskey(uint8_t keyslot, const void* key)
@@ -70,6 +117,7 @@ void setup_aeskey(uint8_t keyslot, const void* key)
             reg_aeskey[i] = _key[i];
         *REG_AESCNT = old_aescnt;
     }
+    invalidate_aeskey(keyslot);
 }
 
 void use_aeskey(uint32_t keyno)
@@ -157,6 +205,16 @@ void subtract_ctr(void* ctr, uint32_t carry)
     }
 }
 
+static void aes_start(size_t blocks, uint32_t mode)
+{
+    *REG_AESCNT = 0;
+    *REG_AESBLKCNT = blocks << 16;
+    *REG_AESCNT = mode |
+                  AES_CNT_START |
+                  AES_CNT_FLUSH_READ |
+                  AES_CNT_FLUSH_WRITE;
+}
+
 void ecb_decrypt(void *inbuf, void *outbuf, size_t size, uint32_t mode)
 {
     aes_decrypt(inbuf, outbuf, size, mode);
@@ -218,6 +276,39 @@ void ctr_decrypt_byte(void *inbuf, void *outbuf, size_t size, size_t off, uint32
         ctr_local[i] = ctr[i];
     add_ctr(ctr_local, off / AES_BLOCK_SIZE);
 
+    // partial head block, full blocks, partial tail block
+    size_t head_len = off_fix ? ((size < AES_BLOCK_SIZE - off_fix) ? size : AES_BLOCK_SIZE - off_fix) : 0;
+    size_t blocks_mid = (size - head_len) / AES_BLOCK_SIZE;
+    size_t tail_len = size - head_len - (blocks_mid * AES_BLOCK_SIZE);
+    size_t blocks_all = (head_len ? 1 : 0) + blocks_mid + (tail_len ? 1 : 0);
+
+    if (blocks_all && (blocks_all <= 0xFFFF)) // all in one go, the counter is set only once
+    {
+        set_ctr(ctr_local);
+        aes_start(blocks_all, mode);
+        if (head_len)
+        {
+            memcpy(temp + off_fix, in, head_len);
+            aes_fifos(temp, temp, 1);
+            memcpy(out, temp + off_fix, head_len);
+            in += head_len;
+            out += head_len;
+        }
+        if (blocks_mid)
+        {
+            aes_fifos(in, out, blocks_mid);
+            in += blocks_mid * AES_BLOCK_SIZE;
+            out += blocks_mid * AES_BLOCK_SIZE;
+        }
+        if (tail_len)
+        {
+            memcpy(temp, in, tail_len);
+            aes_fifos(temp, temp, 1);
+            memcpy(out, temp, tail_len);
+        }
+        return;
+    }
+
     if (off_fix) // handle misaligned offset (at beginning)
     {
         size_t last_byte = ((off_fix + bytes_left) >= AES_BLOCK_SIZE) ?
@@ -278,12 +369,7 @@ void aes_decrypt(void* inbuf, void* outbuf, size_t size, uint32_t mode)
     while (block_count != 0)
     {
         blocks = (block_count >= 0xFFFF) ? 0xFFFF : block_count;
-        *REG_AESCNT = 0;
-        *REG_AESBLKCNT = blocks << 16;
-        *REG_AESCNT = mode |
-                      AES_CNT_START |
-                      AES_CNT_FLUSH_READ |
-                      AES_CNT_FLUSH_WRITE;
+        aes_start(blocks, mode);
         aes_fifos((void*)in, (void*)out, blocks);
         in  += blocks * AES_BLOCK_SIZE;
         out += blocks * AES_BLOCK_SIZE;
@@ -328,10 +414,49 @@ void aes_cmac(void* inbuf, void* outbuf, size_t size)
     }
 }
 
+// word aligned buffers: keep the input FIFO topped up while draining the output FIFO
+static void aes_fifos_aligned(const uint32_t* in, uint32_t* out, size_t blocks)
+{
+    size_t wblocks = 0;
+    size_t rblocks = 0;
+
+    while (rblocks != blocks)
+    {
+        uint32_t cnt = *REG_AESCNT;
+
+        // free input FIFO space, in blocks (FIFO is 16 words deep)
+        size_t wfree = (16 - (cnt & 0x1F)) / 4;
+        if (wfree > blocks - wblocks) wfree = blocks - wblocks;
+        for (wblocks += wfree; wfree; wfree--, in += 4)
+        {
+            *REG_AESWRFIFO = in[0];
+            *REG_AESWRFIFO = in[1];
+            *REG_AESWRFIFO = in[2];
+            *REG_AESWRFIFO = in[3];
+        }
+
+        // completed output blocks
+        size_t ravail = ((cnt >> 5) & 0x1F) / 4;
+        for (rblocks += ravail; ravail; ravail--, out += 4)
+        {
+            out[0] = *REG_AESRDFIFO;
+            out[1] = *REG_AESRDFIFO;
+            out[2] = *REG_AESRDFIFO;
+            out[3] = *REG_AESRDFIFO;
+        }
+    }
+}
+
 void aes_fifos(void* inbuf, void* outbuf, size_t blocks)
 {
     if (!inbuf || !outbuf) return;
 
+    if (!(((uint32_t) inbuf | (uint32_t) outbuf) & 0x3))
+    {
+        aes_fifos_aligned(inbuf, outbuf, blocks);
+        return;
+    }
+
     uint8_t *in = inbuf;
     uint8_t *out = outbuf;
 
@@ -50,6 +50,10 @@ void setup_aeskeyX(uint8_t keyslot, const void* keyx);
 void setup_aeskeyY(uint8_t keyslot, const void* keyy);
 void setup_aeskey(uint8_t keyslot, const void* keyy);
 void use_aeskey(uint32_t keyno);
+void invalidate_aeskey(uint32_t keyslot);
+uint32_t aeskey_state(uint32_t keyslot);
+void setup_aeskeyY_cached(uint8_t keyslot, const void* keyy);
+void aeskey_cache_stats(uint32_t* loads, uint32_t* skipped);
 void set_ctr(void* iv);
 void add_ctr(void* ctr, uint32_t carry);
 void subtract_ctr(void* ctr, uint32_t carry);
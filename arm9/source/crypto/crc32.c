@@ -55,13 +55,70 @@ u32 crc32_adjust(u32 crc32, u8 input) {
     return ((crc32 >> 8) & 0x00ffffff) ^ crc32_table[(crc32 ^ input) & 0xff];
 }
 
+// slice-by-8 tables, generated from the byte table on first use
+static u32 crc32_slice_table[8][256];
+
+static void crc32_init_slice_table(void) {
+    for (u32 i = 0; i < 256; i++)
+        crc32_slice_table[0][i] = crc32_adjust(0, i);
+    for (u32 i = 0; i < 256; i++) {
+        for (u32 k = 1; k < 8; k++) {
+            u32 c = crc32_slice_table[k-1][i];
+            crc32_slice_table[k][i] = (c >> 8) ^ crc32_slice_table[0][c & 0xff];
+        }
+    }
+}
+
 u32 crc32_calculate(u32 crc32, const u8* data, u32 length) {
-    for(unsigned i = 0; i < length; i++) {
-        crc32 = crc32_adjust(crc32, data[i]);
+    const u32 (*t)[256] = crc32_slice_table;
+    if (!t[0][1]) crc32_init_slice_table();
+
+    // byte by byte up to a word boundary, then 8 bytes per step
+    for (; length && ((u32) data & 0x3); length--)
+        crc32 = (crc32 >> 8) ^ t[0][(crc32 ^ *(data++)) & 0xff];
+    for (; length >= 8; length -= 8, data += 8) {
+        u32 lo = *(const u32*) (const void*) data ^ crc32; // little endian
+        u32 hi = *(const u32*) (const void*) (data + 4);
+        crc32 = t[7][lo & 0xff] ^ t[6][(lo >> 8) & 0xff] ^ t[5][(lo >> 16) & 0xff] ^ t[4][lo >> 24] ^
+            t[3][hi & 0xff] ^ t[2][(hi >> 8) & 0xff] ^ t[1][(hi >> 16) & 0xff] ^ t[0][hi >> 24];
     }
+    while (length--)
+        crc32 = (crc32 >> 8) ^ t[0][(crc32 ^ *(data++)) & 0xff];
     return crc32;
 }
 
+// a * b modulo the CRC32 polynomial (reflected)
+static u32 crc32_multmodp(u32 a, u32 b) {
+    u32 m = (u32) 1 << 31;
+    u32 p = 0;
+    for (;;) {
+        if (a & m) {
+            p ^= b;
+            if (!(a & (m - 1))) break;
+        }
+        m >>= 1;
+        b = (b & 1) ? ((b >> 1) ^ 0xedb88320) : (b >> 1);
+    }
+    return p;
+}
+
+// x^(8 * n) modulo the CRC32 polynomial
+static u32 crc32_x8nmodp(u64 n) {
+    u32 x2n = (u32) 1 << 30; // x^1
+    u32 p = (u32) 1 << 31; // x^0
+    // x^(2^k) by repeated squaring, starting at x^8
+    for (u32 k = 0; k < 3; k++) x2n = crc32_multmodp(x2n, x2n);
+    for (; n; n >>= 1) {
+        if (n & 1) p = crc32_multmodp(x2n, p);
+        x2n = crc32_multmodp(x2n, x2n);
+    }
+    return p;
+}
+
+u32 crc32_combine(u32 crc1, u32 crc2, u64 length2) {
+    return crc32_multmodp(crc32_x8nmodp(length2), crc1) ^ crc2;
+}
+
 u32 crc32_calculate_from_file(const char* fileName, u32 offset, u32 length) {
     FIL inputFile;
     u32 crc32 = ~0;
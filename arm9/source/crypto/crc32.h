@@ -9,3 +9,6 @@
 u32 crc32_adjust(u32 crc32, u8 input);
 u32 crc32_calculate(u32 crc32, const u8* data, u32 length);
 u32 crc32_calculate_from_file(const char* fileName, u32 offset, u32 length);
+
+// CRC32 of A|B from the (final) CRC32s of A and B, and the length of B
+u32 crc32_combine(u32 crc1, u32 crc2, u64 length2);
@@ -122,6 +122,7 @@ DSTATUS disk_initialize (
         fat_info->size = getMMCDevice(1)->total_size;
     } else if ((type == TYPE_SYSNAND) || (type == TYPE_EMUNAND) || (type == TYPE_IMGNAND)) {
         NandPartitionInfo nprt_info;
+        InvalidateNandCache(type); // NAND may have changed while not mounted
         if ((type == TYPE_EMUNAND) && !GetNandSizeSectors(NAND_EMUNAND)) // size check for EmuNAND
             return STA_NOINIT|STA_NODISK;
         if ((fat_info->subtype == SUBTYPE_CTRN) &&
@@ -1,5 +1,6 @@
 #include "filetype.h"
 #include "fsutil.h"
+#include "vff.h"
 #include "image.h"
 #include "fatmbr.h"
 #include "nand.h"
@@ -11,7 +12,34 @@
 #include "png.h"
 #include "ui.h" // only for font file detection
 
-u64 IdentifyFileType(const char* path) {
+// recently identified FAT files, keyed by path, size and timestamp
+#define FTYPE_CACHE_SIZE    16
+
+typedef struct {
+    char path[256];
+    u64 fsize;
+    u32 fdatetime;
+    u64 type;
+} FileTypeCacheEntry;
+
+static FileTypeCacheEntry ftype_cache[FTYPE_CACHE_SIZE];
+static u32 ftype_cache_next = 0;
+static u32 ftype_cache_hits = 0;
+static u32 ftype_cache_misses = 0;
+
+void InvalidateFileTypeCache(const char* path) {
+    for (u32 i = 0; i < FTYPE_CACHE_SIZE; i++) {
+        if (!path || (strncasecmp(ftype_cache[i].path, path, 256) == 0))
+            *(ftype_cache[i].path) = '\0';
+    }
+}
+
+void GetFileTypeCacheStats(u32* hits, u32* misses) {
+    if (hits) *hits = ftype_cache_hits;
+    if (misses) *misses = ftype_cache_misses;
+}
+
+static u64 IdentifyFileTypeWorker(const char* path, size_t fsize) {
     static const u8 romfs_magic[] = { ROMFS_MAGIC };
     static const u8 diff_magic[] = { DIFF_MAGIC };
     static const u8 disa_magic[] = { DISA_MAGIC };
@@ -20,10 +48,8 @@ u64 IdentifyFileType(const char* path) {
     static const u8 threedsx_magic[] = { THREEDSX_EXT_MAGIC };
     static const u8 png_magic[] = { PNG_MAGIC };
 
-    if (!path) return 0; // safety
     u8 ALIGN(32) header[0x2C0]; // minimum required size
     void* data = (void*) header;
-    size_t fsize = FileGetSize(path);
     char* fname = strrchr(path, '/');
     char* ext = (fname) ? strrchr(++fname, '.') : NULL;
     u32 id = 0;
@@ -186,3 +212,33 @@ u64 IdentifyFileType(const char* path) {
 
     return 0;
 }
+
+u64 IdentifyFileType(const char* path) {
+    FILINFO fno;
+    if (!path) return 0; // safety
+    if (fvx_stat(path, &fno) != FR_OK) fno.fsize = 0; // handled by the worker
+    else if (!(fno.fattrib & (AM_VRT|AM_DIR)) && (strnlen(path, 256) < 256)) {
+        // virtual files have no timestamp, only real files are cached
+        u32 fdatetime = ((u32) fno.fdate << 16) | fno.ftime;
+        for (u32 i = 0; i < FTYPE_CACHE_SIZE; i++) {
+            FileTypeCacheEntry* entry = &(ftype_cache[i]);
+            if ((entry->fsize == fno.fsize) && (entry->fdatetime == fdatetime) &&
+                (strncasecmp(entry->path, path, 256) == 0)) { // case insensitive, like InvalidateFileTypeCache()
+                ftype_cache_hits++; // saved one header read
+                return entry->type;
+            }
+        }
+
+        ftype_cache_misses++;
+        u64 type = IdentifyFileTypeWorker(path, fno.fsize);
+        FileTypeCacheEntry* entry = &(ftype_cache[ftype_cache_next]);
+        ftype_cache_next = (ftype_cache_next + 1) % FTYPE_CACHE_SIZE;
+        strncpy(entry->path, path, 256);
+        entry->fsize = fno.fsize;
+        entry->fdatetime = fdatetime;
+        entry->type = type;
+        return type;
+    }
+
+    return IdentifyFileTypeWorker(path, fno.fsize);
+}
@@ -79,3 +79,5 @@
 #define FTYPE_AGBSAVE(tp)       (tp&(SYS_AGBSAVE))
 
 u64 IdentifyFileType(const char* path);
+void InvalidateFileTypeCache(const char* path); // NULL for everything
+void GetFileTypeCacheStats(u32* hits, u32* misses);
@@ -1,8 +1,78 @@
 #include "fsdir.h"
 
-void DirEntryCpy(DirEntry* dest, const DirEntry* orig) {
-    memcpy(dest, orig, sizeof(DirEntry));
-    dest->name = dest->path + dest->p_name;
+#define DIR_ENTRIES_MIN 256
+#define DIR_ARENA_MIN   (32 * 1024)
+
+void InitDirStruct(DirStruct* contents) {
+    memset(contents, 0x00, sizeof(DirStruct));
+}
+
+void FreeDirStruct(DirStruct* contents) {
+    if (contents->entry) free(contents->entry);
+    if (contents->arena) free(contents->arena);
+    InitDirStruct(contents);
+}
+
+static char* DirArenaAlloc(DirStruct* contents, u32 len) {
+    if (contents->arena_used + len > contents->arena_size) {
+        u32 arena_size = contents->arena_size ? contents->arena_size : DIR_ARENA_MIN;
+        while (contents->arena_used + len > arena_size) arena_size *= 2;
+        char* arena = (char*) realloc(contents->arena, arena_size);
+        if (!arena) return NULL;
+        contents->arena = arena;
+        contents->arena_size = arena_size;
+        // fix entry->paths and entry->names after realloc
+        for (u32 i = 0; i < contents->n_entries; i++) {
+            DirEntry* entry = &(contents->entry[i]);
+            entry->path = contents->arena + entry->o_path;
+            entry->name = entry->path + entry->p_name;
+        }
+    }
+
+    char* str = contents->arena + contents->arena_used;
+    contents->arena_used += len;
+    return str;
+}
+
+bool SetDirEntryPath(DirStruct* contents, DirEntry* entry, const char* path, u32 p_name) {
+    // name may also be stored behind the path (ie. for root entries)
+    u32 len = p_name + strnlen(path + p_name, 256) + 1;
+    char* str = DirArenaAlloc(contents, len);
+    if (!str) return false;
+    memcpy(str, path, len - 1);
+    str[len-1] = '\0';
+    entry->o_path = str - contents->arena;
+    entry->p_name = p_name;
+    entry->path = str;
+    entry->name = entry->path + entry->p_name;
+    return true;
+}
+
+DirEntry* AddDirEntry(DirStruct* contents, const char* path, u32 p_name) {
+    if (!contents->n_entries) contents->arena_used = 0; // start over
+    if (contents->n_entries >= MAX_DIR_ENTRIES) return NULL;
+    if (contents->n_entries >= contents->max_entries) {
+        u32 max_entries = contents->max_entries ? contents->max_entries * 2 : DIR_ENTRIES_MIN;
+        DirEntry* entries = (DirEntry*) realloc(contents->entry, max_entries * sizeof(DirEntry));
+        if (!entries) return NULL;
+        contents->entry = entries;
+        contents->max_entries = max_entries;
+    }
+
+    DirEntry* entry = &(contents->entry[contents->n_entries]);
+    memset(entry, 0x00, sizeof(DirEntry));
+    if (!SetDirEntryPath(contents, entry, path, p_name)) return NULL;
+    contents->n_entries++;
+    return entry;
+}
+
+DirEntry* DirEntryCpy(DirStruct* dest, const DirEntry* orig) {
+    DirEntry* entry = AddDirEntry(dest, orig->path, orig->p_name);
+    if (!entry) return NULL;
+    entry->size = orig->size;
+    entry->type = orig->type;
+    entry->marked = orig->marked;
+    return entry;
 }
 
 int compDirEntry(const void* e1, const void* e2) {
@@ -16,10 +86,6 @@ int compDirEntry(const void* e1, const void* e2) {
 }
 
 void SortDirStruct(DirStruct* contents) {
+    // paths live in the arena, so entries can be moved around freely
     qsort(contents->entry, contents->n_entries, sizeof(DirEntry), compDirEntry);
-    // fix entry->names after qsort
-    for (int i = 0; i < (int)contents->n_entries; i++) {
-        DirEntry* entry = &(contents->entry[i]);
-        entry->name = entry->path + entry->p_name;
-    }
 }
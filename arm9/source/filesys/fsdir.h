@@ -2,7 +2,7 @@
 
 #include "common.h"
 
-#define MAX_DIR_ENTRIES 2048
+#define MAX_DIR_ENTRIES 8192 // entries beyond this are dropped, like on out of memory
 
 typedef enum {
     T_ROOT,
@@ -13,17 +13,26 @@ typedef enum {
 
 typedef struct {
     char* name; // should point to the correct portion of the path
-    char path[256];
+    char* path; // points into the string arena of the DirStruct
     u64 size;
     EntryType type;
     u8 marked;
     u8 p_name;
+    u32 o_path; // offset of the path inside the string arena
 } DirEntry;
 
 typedef struct {
     u32 n_entries;
-    DirEntry entry[MAX_DIR_ENTRIES];
+    u32 max_entries; // allocated entries (never shrinks)
+    u32 arena_used;
+    u32 arena_size;
+    DirEntry* entry;
+    char* arena; // path (and name) strings, zero terminated
 } DirStruct;
 
-void DirEntryCpy(DirEntry* dest, const DirEntry* orig);
+void InitDirStruct(DirStruct* contents);
+void FreeDirStruct(DirStruct* contents);
+DirEntry* AddDirEntry(DirStruct* contents, const char* path, u32 p_name);
+bool SetDirEntryPath(DirStruct* contents, DirEntry* entry, const char* path, u32 p_name);
+DirEntry* DirEntryCpy(DirStruct* dest, const DirEntry* orig);
 void SortDirStruct(DirStruct* contents);
@@ -1,33 +1,181 @@
 #include "fsgame.h"
 #include "fsperm.h"
+#include "filetype.h"
 #include "gameutil.h"
+#include "fsdrive.h"
+#include "image.h"
 #include "tie.h"
+#include "sha.h"
 #include "ui.h"
 #include "vff.h"
 
+// only ever kept on the SD card, this must never cause implicit writes to CTRNAND
+#define TITLE_CACHE_DIR     "0:/gm9/support"
+#define TITLE_CACHE_PATH    TITLE_CACHE_DIR "/gm9titles.cache"
+#define TITLE_CACHE_MAGIC   "GM9T"
+#define TITLE_CACHE_VERSION 1
+#define TITLE_CACHE_MAX     1024 // max number of cached titles (all title DBs combined)
+
+typedef struct {
+    char magic[4];
+    u32 version;
+    u32 n_entries;
+    u32 reserved;
+} PACKED_STRUCT TitleCacheHeader;
+
+typedef struct {
+    u8 key[16]; // truncated SHA-256, see GetTitleCacheKey()
+    char name[128]; // good name, zero terminated
+} PACKED_STRUCT TitleCacheEntry;
+
+static int CompareTitleCacheEntry(const void* a, const void* b) {
+    return memcmp(a, b, 16);
+}
+
+// the key covers everything the good name depends on:
+// mounted title DB, TIE path & contents, and size / timestamp of the TMD
+static bool GetTitleCacheKey(u8* key, const char* path, const TitleInfoEntry* tie) {
+    struct {
+        char mntpath[256];
+        char path[256];
+        TitleInfoEntry tie;
+        u64 tmd_size;
+        u32 tmd_datetime;
+    } PACKED_STRUCT keydata;
+    const char* mntpath = GetMountPath();
+    char path_tmd[64];
+    FILINFO fno;
+    u8 hash[32];
+
+    if (!mntpath || (GetTieTmdPath(path_tmd, path) != 0) || (fvx_stat(path_tmd, &fno) != FR_OK))
+        return false;
+
+    memset(&keydata, 0, sizeof(keydata));
+    strncpy(keydata.mntpath, mntpath, 256 - 1);
+    strncpy(keydata.path, path, 256 - 1);
+    memcpy(&(keydata.tie), tie, sizeof(TitleInfoEntry));
+    keydata.tmd_size = fno.fsize;
+    keydata.tmd_datetime = ((u32) fno.fdate << 16) | fno.ftime;
+
+    sha_quick(hash, &keydata, sizeof(keydata), SHA256_MODE);
+    memcpy(key, hash, 16);
+    return true;
+}
+
+// returns the number of entries, cache has to be able to hold TITLE_CACHE_MAX entries
+static u32 LoadTitleCache(TitleCacheEntry* cache) {
+    u32 cache_size = sizeof(TitleCacheHeader) + (TITLE_CACHE_MAX * sizeof(TitleCacheEntry));
+    u8* buffer = malloc(cache_size + 1);
+    u32 n_entries = 0;
+    if (!buffer) return 0;
+
+    TitleCacheHeader* hdr = (TitleCacheHeader*) (void*) buffer;
+    UINT len = 0;
+    if ((fvx_qread(TITLE_CACHE_PATH, buffer, 0, cache_size + 1, &len) == FR_OK) &&
+        (len >= sizeof(TitleCacheHeader)) && (memcmp(hdr->magic, TITLE_CACHE_MAGIC, 4) == 0) &&
+        (hdr->version == TITLE_CACHE_VERSION) && (hdr->n_entries <= TITLE_CACHE_MAX) &&
+        (len == sizeof(TitleCacheHeader) + (hdr->n_entries * sizeof(TitleCacheEntry)))) {
+        n_entries = hdr->n_entries;
+        memcpy(cache, buffer + sizeof(TitleCacheHeader), n_entries * sizeof(TitleCacheEntry));
+    }
+
+    free(buffer);
+    return n_entries;
+}
+
+static bool SaveTitleCache(const TitleCacheEntry* cache, u32 n_entries) {
+    u32 cache_size = sizeof(TitleCacheHeader) + (n_entries * sizeof(TitleCacheEntry));
+    // SD card has to be mounted and the user has to allow writing to it,
+    // otherwise the cache just isn't saved (and they aren't asked again)
+    static bool save_declined = false;
+    if (save_declined || !(DriveType(TITLE_CACHE_DIR) & DRV_SDCARD))
+        return false;
+    if (!CheckWritePermissions(TITLE_CACHE_PATH)) {
+        save_declined = true;
+        return false;
+    }
+
+    u8* buffer = malloc(cache_size);
+    if (!buffer) return false;
+
+    TitleCacheHeader* hdr = (TitleCacheHeader*) (void*) buffer;
+    memset(hdr, 0, sizeof(TitleCacheHeader));
+    memcpy(hdr->magic, TITLE_CACHE_MAGIC, 4);
+    hdr->version = TITLE_CACHE_VERSION;
+    hdr->n_entries = n_entries;
+    memcpy(buffer + sizeof(TitleCacheHeader), cache, n_entries * sizeof(TitleCacheEntry));
+
+    bool res = false;
+    if ((fvx_rmkdir(TITLE_CACHE_DIR) == FR_OK) || (fvx_stat(TITLE_CACHE_DIR, NULL) == FR_OK)) {
+        fvx_unlink(TITLE_CACHE_PATH);
+        res = (fvx_qwrite(TITLE_CACHE_PATH, buffer, 0, cache_size, NULL) == FR_OK);
+    }
+    free(buffer);
+    return res;
+}
+
 void SetupTitleManager(DirStruct* contents) {
-    char goodname[256];
+    char npath[256 + 256];
+
+    // good names are cached across sessions, only changed titles get looked up
+    TitleCacheEntry* cache = malloc(2 * TITLE_CACHE_MAX * sizeof(TitleCacheEntry));
+    TitleCacheEntry* cache_new = cache ? cache + TITLE_CACHE_MAX : NULL;
+    u8 cache_used[TITLE_CACHE_MAX] = { 0 };
+    u32 n_cache = 0;
+    u32 n_cache_new = 0;
+    bool cache_changed = false;
+    if (cache) {
+        n_cache = LoadTitleCache(cache);
+        qsort(cache, n_cache, sizeof(TitleCacheEntry), CompareTitleCacheEntry);
+    }
+
     ShowProgress(0, 0, "");
     for (u32 s = 0; s < contents->n_entries; s++) {
         DirEntry* entry = &(contents->entry[s]);
         // set good name for entry
         u32 plen = strnlen(entry->path, 256);
+        char* goodname = npath + plen + 1;
         if (!ShowProgress(s+1, contents->n_entries, entry->path)) break;
-        if ((GetGoodName(goodname, entry->path, false) != 0) ||
-            (plen + 1 + strnlen(goodname, 256) + 1 > 256))
-            continue;
-        entry->p_name = plen + 1;
-        entry->name = entry->path + entry->p_name;
-        snprintf(entry->name, 256 - entry->p_name, "%s", goodname);
-        // grab title size from tie
+        // title size and cache key from tie
         TitleInfoEntry tie;
         if (fvx_qread(entry->path, &tie, 0, sizeof(TitleInfoEntry), NULL) != FR_OK)
             continue;
+        u8 key[16];
+        bool keyed = cache && GetTitleCacheKey(key, entry->path, &tie);
+        TitleCacheEntry* hit = keyed ? bsearch(key, cache, n_cache, sizeof(TitleCacheEntry), CompareTitleCacheEntry) : NULL;
+        if (hit) {
+            strncpy(goodname, hit->name, 128);
+            goodname[127] = '\0';
+            cache_used[hit - cache] = 1;
+        } else if (GetGoodName(goodname, entry->path, false) != 0) {
+            continue;
+        } else if (keyed) {
+            cache_changed = true;
+        }
+        if (plen + 1 + strnlen(goodname, 256) + 1 > 256)
+            continue;
+        if (keyed && (n_cache_new < TITLE_CACHE_MAX)) {
+            memcpy(cache_new[n_cache_new].key, key, 16);
+            strncpy(cache_new[n_cache_new].name, goodname, 128);
+            n_cache_new++;
+        }
+        // name is stored behind the path
+        memcpy(npath, entry->path, plen + 1);
+        if (!SetDirEntryPath(contents, entry, npath, plen + 1))
+            break;
         entry->size = tie.title_size;
     }
+
+    // keep entries from other title DBs (as long as there is room)
+    if (cache_changed) {
+        for (u32 i = 0; (i < n_cache) && (n_cache_new < TITLE_CACHE_MAX); i++)
+            if (!cache_used[i]) memcpy(&(cache_new[n_cache_new++]), &(cache[i]), sizeof(TitleCacheEntry));
+        SaveTitleCache(cache_new, n_cache_new);
+    }
+    free(cache);
 }
 
-bool GoodRenamer(DirEntry* entry, bool ask) {
+bool GoodRenamer(DirStruct* contents, DirEntry* entry, bool ask) {
     char goodname[256]; // get goodname
     if ((GetGoodName(goodname, entry->path, false) != 0) ||
         (strncmp(goodname + strnlen(goodname, 256) - 4, ".tmd", 4) == 0)) // no TMD, please
@@ -51,9 +199,11 @@ bool GoodRenamer(DirEntry* entry, bool ask) {
     strncpy(nname, goodname, 256 - 1 - (nname - npath));
     // actual rename
     if (!CheckDirWritePermissions(entry->path)) return false;
+    InvalidateFileTypeCache(entry->path);
+    InvalidateFileTypeCache(npath);
     if (f_rename(entry->path, npath) != FR_OK) return false;
-    strncpy(entry->path, npath, 256);
-    entry->name = entry->path + (nname - npath);
+    if (!SetDirEntryPath(contents, entry, npath, nname - npath))
+        return false; // renamed, but the entry couldn't be updated
 
     return true;
 }
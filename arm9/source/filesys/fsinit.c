@@ -3,6 +3,7 @@
 #include "virtual.h"
 #include "sddata.h"
 #include "image.h"
+#include "filetype.h"
 #include "ff.h"
 
 // FATFS filesystem objects (x10)
@@ -12,12 +13,14 @@ static FATFS fs[NORM_FS];
 static bool fs_mounted[NORM_FS] = { false };
 
 bool InitSDCardFS() {
+    InvalidateFileTypeCache(NULL); // the card might have been swapped
     fs_mounted[0] = (f_mount(fs, "0:", 1) == FR_OK);
     return fs_mounted[0];
 }
 
 bool InitExtFS() {
     static bool ramdrv_ready = false;
+    InvalidateFileTypeCache(NULL);
 
     for (u32 i = 1; i < NORM_FS; i++) {
         char fsname[8];
@@ -40,6 +43,7 @@ bool InitExtFS() {
 }
 
 bool InitImgFS(const char* path) {
+    InvalidateFileTypeCache(NULL); // image drives get new contents
     // find drive # of the last image FAT drive
     u32 drv_i = NORM_FS - IMGN_FS;
     char fsname[8];
@@ -8,6 +8,7 @@
 #include "image.h"
 #include "sha.h"
 #include "sdmmc.h"
+#include "nand.h"
 #include "ff.h"
 #include "ui.h"
 #include "swkbd.h"
@@ -78,6 +79,7 @@ bool FormatSDCard(u64 hidden_mb, u32 cluster_size, const char* label) {
         ShowPrompt(false, "Error: SD card i/o failure");
         return false;
     }
+    InvalidateNandCache(NAND_EMUNAND); // raw SD writes bypass the NAND sector cache
 
     // format the SD card
     VolToPart[0].pt = 1; // workaround to prevent FatFS rebuilding the MBR
@@ -199,6 +201,18 @@ bool FileGetSha256(const char* path, u8* sha256, u64 offset, u64 size) {
     return ret;
 }
 
+// Boyer-Moore-Horspool search, returns the offset of the first match or (u32) -1
+static u32 FindDataInBuffer(const u8* buffer, u32 size, const u8* data, u32 size_data, const u32* skip) {
+    if (!size_data) return 0;
+    if (size < size_data) return (u32) -1;
+    u8 last = data[size_data - 1];
+    for (u32 i = 0; i <= size - size_data; i += skip[buffer[i + size_data - 1]]) {
+        if ((buffer[i + size_data - 1] == last) && (memcmp(buffer + i, data, size_data - 1) == 0))
+            return i;
+    }
+    return (u32) -1;
+}
+
 u32 FileFindData(const char* path, u8* data, u32 size_data, u32 offset_file) {
     FIL file; // used for FAT & virtual
     u64 found = (u64) -1;
@@ -210,6 +224,11 @@ u32 FileFindData(const char* path, u8* data, u32 size_data, u32 offset_file) {
     u8* buffer = (u8*) malloc(STD_BUFFER_SIZE);
     if (!buffer) return false;
 
+    // bad character skip table
+    u32 skip[256];
+    for (u32 i = 0; i < 256; i++) skip[i] = size_data ? size_data : 1;
+    for (u32 i = 0; i + 1 < size_data; i++) skip[data[i]] = size_data - 1 - i;
+
     // main routine
     for (u32 pass = 0; pass < 2; pass++) {
         bool show_progress = false;
@@ -222,12 +241,8 @@ u32 FileFindData(const char* path, u8* data, u32 size_data, u32 offset_file) {
             fvx_lseek(&file, pos);
             if ((fvx_read(&file, buffer, read_bytes, &btr) != FR_OK) || (btr != read_bytes))
                 break;
-            for (u32 i = 0; i + size_data <= read_bytes; i++) {
-                if (memcmp(buffer + i, data, size_data) == 0) {
-                    found = pos + i;
-                    break;
-                }
-            }
+            u32 i = FindDataInBuffer(buffer, read_bytes, data, size_data, skip);
+            if (i != (u32) -1) found = pos + i;
             if (!show_progress && (found == (u64) -1) && (pos + read_bytes < fsize)) {
                 ShowProgress(0, 0, path);
                 show_progress = true;
@@ -822,8 +837,9 @@ bool FileSelectorWorker(char* result, const char* text, const char* path, const
 
         while (pos < contents->n_entries) {
             char opt_names[_MAX_FS_OPT+1][32+1];
-            DirEntry* res_entry[MAX_DIR_ENTRIES+1] = { NULL };
+            DirEntry** res_entry = (DirEntry**) calloc(contents->n_entries + 1, sizeof(DirEntry*));
             u32 n_opt = 0;
+            if (!res_entry) return false;
             for (; pos < contents->n_entries; pos++) {
                 DirEntry* entry = &(contents->entry[pos]);
                 if (((entry->type == T_DIR) && no_dirs) ||
@@ -849,14 +865,18 @@ bool FileSelectorWorker(char* result, const char* text, const char* path, const
             }
             if ((pos >= contents->n_entries) && (n_opt < n_found) && !new_style)
                 snprintf(opt_names[n_opt++], 32, "[more...]");
-            if (!n_opt) break;
+            if (!n_opt) {
+                free(res_entry);
+                break;
+            }
 
             const char* optionstr[_MAX_FS_OPT+1] = { NULL };
             for (u32 i = 0; i <= _MAX_FS_OPT; i++) optionstr[i] = opt_names[i];
             u32 user_select = new_style ? ShowFileScrollPrompt(n_opt, (const DirEntry**)res_entry, hide_ext, "%s", text)
                                         : ShowSelectPrompt(n_opt, optionstr, "%s", text);
+            DirEntry* res_local = user_select ? res_entry[user_select-1] : NULL;
+            free(res_entry);
             if (!user_select) return false;
-            DirEntry* res_local = res_entry[user_select-1];
             if (res_local && (res_local->type == T_DIR)) { // selected dir
                 if (select_dirs) {
                     strncpy(result, res_local->path, 256);
@@ -882,8 +902,10 @@ bool FileSelectorWorker(char* result, const char* text, const char* path, const
 bool FileSelector(char* result, const char* text, const char* path, const char* pattern, u32 flags, bool new_style) {
     void* buffer = (void*) malloc(sizeof(DirStruct));
     if (!buffer) return false;
+    InitDirStruct((DirStruct*) buffer);
 
     bool ret = FileSelectorWorker(result, text, path, pattern, flags, buffer, new_style);
+    FreeDirStruct((DirStruct*) buffer);
     free(buffer);
     return ret;
 }
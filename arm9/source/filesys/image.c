@@ -2,9 +2,14 @@
 #include "vff.h"
 #include "nandcmac.h"
 
+#define CLMT_MIN_SIZE   64 // DWORDs, enough for 31 fragments
+
 static FIL mount_file;
 static u64 mount_state = 0;
 
+// cluster link map table for fast seeks inside the mounted image
+static DWORD* mount_clmt = NULL;
+
 static char mount_path[256] = { 0 };
 
 static bool fix_cmac = false;
@@ -23,15 +28,22 @@ int ReadImageBytes(void* buffer, u64 offset, u64 count) {
     return (ret != 0) ? (int) ret : (bytes_read != count) ? -1 : 0;
 }
 
+static bool SetupImageFastSeek(void);
+static void FreeImageFastSeek(void);
+
 int WriteImageBytes(const void* buffer, u64 offset, u64 count) {
     UINT bytes_written;
     UINT ret;
     if (!count) return -1;
     if (!mount_state) return FR_INVALID_OBJECT;
+    // with the link map active, FatFs clips seeks at the file size and can't extend the cluster chain
+    bool relink = mount_clmt && ((offset + count) >= fvx_size(&mount_file));
+    if (relink) FreeImageFastSeek();
     if (fvx_tell(&mount_file) != offset)
         fvx_lseek(&mount_file, offset);
     ret = fvx_write(&mount_file, buffer, count, &bytes_written);
     if (ret == 0) fix_cmac = true;
+    if (relink) SetupImageFastSeek(); // falls back to regular seeks on failure
     return (ret != 0) ? (int) ret : (bytes_written != count) ? -1 : 0;
 }
 
@@ -59,6 +71,37 @@ const char* GetMountPath(void) {
     return mount_path;
 }
 
+static bool SetupImageFastSeek(void) {
+    // only possible for real FAT files, virtual files seek in O(1) anyways
+    if (!mount_file.obj.fs) return false;
+
+    // first try with a small table, then retry with the required size
+    u32 clmt_size = CLMT_MIN_SIZE;
+    for (u32 i = 0; i < 2; i++) {
+        mount_clmt = (DWORD*) malloc(clmt_size * sizeof(DWORD));
+        if (!mount_clmt) break;
+        mount_clmt[0] = clmt_size;
+        mount_file.cltbl = mount_clmt;
+        FRESULT res = f_lseek(&mount_file, CREATE_LINKMAP);
+        if (res == FR_OK) return true;
+        clmt_size = mount_clmt[0]; // required size
+        mount_file.cltbl = NULL;
+        free(mount_clmt);
+        mount_clmt = NULL;
+        if (res != FR_NOT_ENOUGH_CORE) break;
+    }
+
+    return false;
+}
+
+static void FreeImageFastSeek(void) {
+    mount_file.cltbl = NULL;
+    if (mount_clmt) {
+        free(mount_clmt);
+        mount_clmt = NULL;
+    }
+}
+
 u64 MountImage(const char* path) {
     if (mount_state) {
         fvx_close(&mount_file);
@@ -67,11 +110,13 @@ u64 MountImage(const char* path) {
         mount_state = 0;
         *mount_path = 0;
     }
+    FreeImageFastSeek();
     u64 type = (path) ? IdentifyFileType(path) : 0;
     if (!type) return 0;
     if ((fvx_open(&mount_file, path, FA_READ | FA_WRITE | FA_OPEN_EXISTING) != FR_OK) &&
         (fvx_open(&mount_file, path, FA_READ | FA_OPEN_EXISTING) != FR_OK))
         return 0;
+    SetupImageFastSeek(); // falls back to regular seeks on failure
     fvx_lseek(&mount_file, 0);
     fvx_sync(&mount_file);
     strncpy(mount_path, path, 255);
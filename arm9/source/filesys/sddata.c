@@ -11,7 +11,12 @@ typedef struct {
     FIL* fptr;
     u8 ctr[16];
     u8 keyy[16];
-} PACKED_STRUCT FilCryptInfo;
+    // DSiWare export state, cached between reads
+    bool tad_valid;
+    u32 tad_tbl[sizeof(TadContentTable) / sizeof(u32)];
+    FSIZE_t iv_ofs; // offset of the block the cached iv decrypts / 0 if none
+    u8 iv[AES_BLOCK_SIZE] __attribute__((aligned(4)));
+} FilCryptInfo;
 
 static FilCryptInfo filcrypt[NUM_FILCRYPTINFO] = { 0 };
 
@@ -55,29 +60,46 @@ FilCryptInfo* fx_find_cryptinfo(FIL* fptr) {
     return info;
 }
 
-FRESULT fx_decrypt_dsiware (FIL* fp, void* buff, FSIZE_t ofs, UINT len) {
-    const u32 mode = AES_CNT_TITLEKEY_DECRYPT_MODE;
+FRESULT fx_setup_dsiware (FilCryptInfo* info, FIL* fp) {
     const u32 num_tbl = sizeof(TadContentTable) / sizeof(u32);
-    const FSIZE_t ofs0 = f_tell(fp);
-
     u8 __attribute__((aligned(16))) iv[AES_BLOCK_SIZE];
-    u32 tbl[num_tbl];
     u8 hdr[TAD_HEADER_LEN];
 
     FRESULT res;
     UINT br;
 
-
-    // read and decrypt header
+    // read and decrypt header (only once per opened file)
     if ((res = f_lseek(fp, TAD_HEADER_OFFSET)) != FR_OK) return res;
     if ((res = f_read(fp, hdr, TAD_HEADER_LEN, &br)) != FR_OK) return res;
     if (br != TAD_HEADER_LEN) return FR_DENIED;
     memcpy(iv, hdr + TAD_HEADER_LEN - AES_BLOCK_SIZE, AES_BLOCK_SIZE);
-    cbc_decrypt(hdr, hdr, sizeof(TadHeader) / AES_BLOCK_SIZE, mode, iv);
+    cbc_decrypt(hdr, hdr, sizeof(TadHeader) / AES_BLOCK_SIZE, AES_CNT_TITLEKEY_DECRYPT_MODE, iv);
 
     // setup the table
-    if (BuildTadContentTable(tbl, hdr) != 0) return FR_DENIED;
-    if (tbl[num_tbl-1] > f_size(fp)) return FR_DENIED; // obviously missing data
+    if (BuildTadContentTable(info->tad_tbl, hdr) != 0) return FR_DENIED;
+    if (info->tad_tbl[num_tbl-1] > f_size(fp)) return FR_DENIED; // obviously missing data
+
+    info->tad_valid = true;
+    info->iv_ofs = 0;
+    return FR_OK;
+}
+
+FRESULT fx_decrypt_dsiware (FilCryptInfo* info, FIL* fp, void* buff, FSIZE_t ofs, UINT len) {
+    const u32 mode = AES_CNT_TITLEKEY_DECRYPT_MODE;
+    const u32 num_tbl = sizeof(TadContentTable) / sizeof(u32);
+    const FSIZE_t ofs0 = f_tell(fp);
+    u32* tbl = info->tad_tbl;
+    u8* iv = info->iv;
+
+    FRESULT res;
+    UINT br;
+
+
+    // header and content table are cached in the crypto info
+    if (!info->tad_valid && ((res = fx_setup_dsiware(info, fp)) != FR_OK)) {
+        f_lseek(fp, ofs0);
+        return res;
+    }
 
 
     // process sections
@@ -96,11 +118,14 @@ FRESULT fx_decrypt_dsiware (FIL* fp, void* buff, FSIZE_t ofs, UINT len) {
         if ((sct_start < ofs) || (sct_end > ofs + len)) { // incomplete section, ugh
             u8 __attribute__((aligned(16))) block[AES_BLOCK_SIZE];
 
-            // load iv0
+            // load iv0 (not needed when continuing from the previous read)
             FSIZE_t block0_ofs = data_pos - (data_pos % AES_BLOCK_SIZE);
             FSIZE_t iv0_ofs = ((block0_ofs > sct_start) ? block0_ofs : sct_end) - AES_BLOCK_SIZE;
-            if ((res = f_lseek(fp, iv0_ofs)) != FR_OK) return res;
-            if ((res = f_read(fp, iv, AES_BLOCK_SIZE, &br)) != FR_OK) return res;
+            if (info->iv_ofs != block0_ofs) {
+                info->iv_ofs = 0;
+                if ((res = f_lseek(fp, iv0_ofs)) != FR_OK) return res;
+                if ((res = f_read(fp, iv, AES_BLOCK_SIZE, &br)) != FR_OK) return res;
+            }
 
             // load and decrypt block0 (if misaligned)
             if (data_pos % AES_BLOCK_SIZE) {
@@ -109,6 +134,7 @@ FRESULT fx_decrypt_dsiware (FIL* fp, void* buff, FSIZE_t ofs, UINT len) {
                 cbc_decrypt(block, block, 1, mode, iv);
                 data_pos = min(block0_ofs + AES_BLOCK_SIZE, data_end);
                 memcpy(buff, block + (ofs - block0_ofs), data_pos - ofs);
+                info->iv_ofs = block0_ofs + AES_BLOCK_SIZE;
             }
 
             // decrypt blocks in between
@@ -117,6 +143,7 @@ FRESULT fx_decrypt_dsiware (FIL* fp, void* buff, FSIZE_t ofs, UINT len) {
                 u8* blocks = (u8*) buff + (data_pos - ofs);
                 cbc_decrypt(blocks, blocks, num_blocks, mode, iv);
                 data_pos += num_blocks * AES_BLOCK_SIZE;
+                info->iv_ofs = data_pos;
             }
 
             // decrypt last block
@@ -127,6 +154,7 @@ FRESULT fx_decrypt_dsiware (FIL* fp, void* buff, FSIZE_t ofs, UINT len) {
                 if ((res = f_read(fp, block, AES_BLOCK_SIZE, &br)) != FR_OK) return res;
                 cbc_decrypt(block, block, 1, mode, iv);
                 memcpy(lbuff, block, data_end - data_pos);
+                info->iv_ofs = data_pos + AES_BLOCK_SIZE;
                 data_pos = data_end;
             }
         } else { // complete section (thank god for these!)
@@ -135,16 +163,17 @@ FRESULT fx_decrypt_dsiware (FIL* fp, void* buff, FSIZE_t ofs, UINT len) {
             u32 num_blocks = (crypt_end - sct_start) / AES_BLOCK_SIZE;
             memcpy(iv, iv0, AES_BLOCK_SIZE);
             cbc_decrypt(blocks, blocks, num_blocks, mode, iv);
+            info->iv_ofs = crypt_end;
         }
     }
 
-    return f_lseek(fp, ofs0);
+    return (f_tell(fp) != ofs0) ? f_lseek(fp, ofs0) : FR_OK;
 }
 
 FRESULT fx_open (FIL* fp, const TCHAR* path, BYTE mode) {
     int num = alias_num(path);
     FilCryptInfo* info = fx_find_cryptinfo(fp);
-    if (info) info->fptr = NULL;
+    if (info) memset(info, 0, sizeof(FilCryptInfo));
 
     if (info && (num >= 0)) {
         // DSIWare Export, mark with the magic number
@@ -181,9 +210,9 @@ FRESULT fx_read (FIL* fp, void* buff, UINT btr, UINT* br) {
     FSIZE_t off = f_tell(fp);
     FRESULT res = f_read(fp, buff, btr, br);
     if (info && info->fptr) {
-        setup_aeskeyY(0x34, info->keyy);
+        setup_aeskeyY_cached(0x34, info->keyy); // no key setup for consecutive reads
         use_aeskey(0x34);
-        if (memcmp(info->ctr, DSIWARE_MAGIC, 16) == 0) fx_decrypt_dsiware(fp, buff, off, btr);
+        if (memcmp(info->ctr, DSIWARE_MAGIC, 16) == 0) fx_decrypt_dsiware(info, fp, buff, off, btr);
         else ctr_decrypt_byte(buff, buff, btr, off, AES_CNT_CTRNAND_MODE, info->ctr);
     }
     return res;
@@ -199,7 +228,7 @@ FRESULT fx_write (FIL* fp, const void* buff, UINT btw, UINT* bw) {
         void* crypt_buff = (void*) malloc(min(btw, STD_BUFFER_SIZE));
         if (!crypt_buff) return FR_DENIED;
 
-        setup_aeskeyY(0x34, info->keyy);
+        setup_aeskeyY_cached(0x34, info->keyy);
         use_aeskey(0x34);
         *bw = 0;
         for (UINT p = 0; (p < btw) && (res == FR_OK); p += STD_BUFFER_SIZE) {
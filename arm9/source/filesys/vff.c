@@ -1,4 +1,5 @@
 #include "virtual.h"
+#include "filetype.h"
 #include "ffconf.h"
 #include "vff.h"
 
@@ -15,6 +16,8 @@
 #define VDIR(dp) ((VirtualDir*) (void*) &(dp->dptr))
 
 FRESULT fvx_open (FIL* fp, const TCHAR* path, BYTE mode) {
+    if (mode & (FA_WRITE|FA_CREATE_ALWAYS|FA_CREATE_NEW|FA_OPEN_ALWAYS))
+        InvalidateFileTypeCache(path);
     #if _VFIL_ENABLED
     VirtualFile* vfile = VFIL(fp);
     memset(fp, 0, sizeof(FIL));
@@ -56,6 +59,8 @@ FRESULT fvx_close (FIL* fp) {
     #if _VFIL_ENABLED
     if (fp->obj.fs == NULL) return FR_OK;
     #endif
+    // size / timestamp only get their final values here, path is unknown
+    if (fp->flag & FA_WRITE) InvalidateFileTypeCache(NULL);
     return fx_close( fp );
 }
 
@@ -75,6 +80,7 @@ FRESULT fvx_sync (FIL* fp) {
     #if _VFIL_ENABLED
     if (fp->obj.fs == NULL) return FR_OK;
     #endif
+    if (fp->flag & FA_WRITE) InvalidateFileTypeCache(NULL);
     return f_sync( fp );
 }
 
@@ -96,10 +102,13 @@ FRESULT fvx_stat (const TCHAR* path, FILINFO* fno) {
 
 FRESULT fvx_rename (const TCHAR* path_old, const TCHAR* path_new) {
     if ((GetVirtualSource(path_old)) || CheckAliasDrive(path_old)) return FR_DENIED;
+    InvalidateFileTypeCache(path_old);
+    InvalidateFileTypeCache(path_new);
     return f_rename( path_old, path_new );
 }
 
 FRESULT fvx_unlink (const TCHAR* path) {
+    InvalidateFileTypeCache(path);
     if (GetVirtualSource(path)) {
         VirtualFile vfile;
         if (!GetVirtualFile(&vfile, path, FA_READ)) return FR_NO_PATH;
@@ -313,6 +322,7 @@ FRESULT worker_fvx_runlink (TCHAR* tpath) {
 #endif
 
 FRESULT fvx_runlink (const TCHAR* path) {
+    InvalidateFileTypeCache(NULL); // whole directories may be gone
     #if !_LFN_UNICODE // this will not work for unicode
     TCHAR tpath[_MAX_FN_LEN+1];
     if (strlen(path) > _MAX_FN_LEN) return FR_INVALID_NAME;
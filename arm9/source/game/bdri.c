@@ -76,9 +76,54 @@ typedef struct {
     Ticket ticket;
 } __attribute__((packed, aligned(4))) TicketEntry;
 
+#define BDRI_CACHE_BLOCKS 16 // number of data blocks kept in the read cache
+#define BDRI_CACHE_MAX_BLOCK_SIZE 0x1000
+
+typedef struct {
+    u32 offset; // file offset of the cached block / (u32) -1 if unused
+    u32 last_use;
+} BDRICacheBlock;
+
 static FIL* bdrifp;
 
-static FRESULT BDRIRead(UINT ofs, UINT btr, void* buf) {
+static u8* bdri_cache = NULL;
+static BDRICacheBlock bdri_cache_block[BDRI_CACHE_BLOCKS];
+static u32 bdri_cache_block_size = 0;
+static u32 bdri_cache_tick = 0;
+
+static void BDRIFreeCache(void) {
+    if (bdri_cache) free(bdri_cache);
+    bdri_cache = NULL;
+    bdri_cache_block_size = 0;
+}
+
+static void BDRISetupCache(u32 block_size) {
+    if (bdri_cache && (bdri_cache_block_size == block_size))
+        return; // already set up for this file
+    BDRIFreeCache();
+    if (!block_size || (block_size & (block_size - 1)) || (block_size > BDRI_CACHE_MAX_BLOCK_SIZE))
+        return; // no cache, not a sane block size
+    bdri_cache = (u8*) malloc(BDRI_CACHE_BLOCKS * block_size);
+    if (!bdri_cache) return;
+    for (u32 i = 0; i < BDRI_CACHE_BLOCKS; i++)
+        bdri_cache_block[i].offset = (u32) -1;
+    bdri_cache_block_size = block_size;
+}
+
+static FRESULT BDRIOpen(FIL* file, const char* path, BYTE mode) {
+    FRESULT res = fvx_open(file, path, mode);
+    if (res == FR_OK) bdrifp = file;
+    BDRIFreeCache(); // cache is set up on first use
+    return res;
+}
+
+static void BDRIClose(void) {
+    if (bdrifp) fvx_close(bdrifp);
+    bdrifp = NULL;
+    BDRIFreeCache();
+}
+
+static FRESULT BDRIReadRaw(UINT ofs, UINT btr, void* buf) {
     if (bdrifp) {
         FRESULT res;
         UINT br;
@@ -90,6 +135,49 @@ static FRESULT BDRIRead(UINT ofs, UINT btr, void* buf) {
     } else return FR_DENIED;
 }
 
+static u8* BDRIGetCacheBlock(UINT ofs) {
+    BDRICacheBlock* lru = bdri_cache_block;
+    u32 i;
+
+    for (i = 0; i < BDRI_CACHE_BLOCKS; i++) {
+        BDRICacheBlock* block = bdri_cache_block + i;
+        if (block->offset == ofs) break;
+        if (block->last_use < lru->last_use) lru = block;
+    }
+
+    if (i >= BDRI_CACHE_BLOCKS) { // not cached, load into least recently used block
+        i = lru - bdri_cache_block;
+        lru->offset = (u32) -1;
+        if (BDRIReadRaw(ofs, bdri_cache_block_size, bdri_cache + (i * bdri_cache_block_size)) != FR_OK)
+            return NULL;
+        lru->offset = ofs;
+    }
+
+    bdri_cache_block[i].last_use = ++bdri_cache_tick;
+    return bdri_cache + (i * bdri_cache_block_size);
+}
+
+static FRESULT BDRIRead(UINT ofs, UINT btr, void* buf) {
+    const u32 bsize = bdri_cache_block_size;
+    u8* buf8 = (u8*) buf;
+
+    // small reads (hash buckets, file entries, FAT nodes) go through the cache
+    if (!bdri_cache || (btr >= bsize))
+        return BDRIReadRaw(ofs, btr, buf);
+
+    for (UINT pos = ofs; pos < ofs + btr;) {
+        UINT block_ofs = pos - (pos % bsize);
+        UINT len = min(block_ofs + bsize, ofs + btr) - pos;
+        u8* block = BDRIGetCacheBlock(block_ofs);
+        if (!block) // end of file or error, let the uncached read decide
+            return BDRIReadRaw(ofs, btr, buf);
+        memcpy(buf8 + (pos - ofs), block + (pos - block_ofs), len);
+        pos += len;
+    }
+
+    return FR_OK;
+}
+
 static FRESULT BDRIWrite(UINT ofs, UINT btw, const void* buf) {
     if (bdrifp) {
         FRESULT res;
@@ -98,6 +186,20 @@ static FRESULT BDRIWrite(UINT ofs, UINT btw, const void* buf) {
             (fvx_lseek(bdrifp, ofs) != FR_OK)) return FR_DENIED;
         res = fvx_write(bdrifp, buf, btw, &bw);
         if ((res == FR_OK) && (bw != btw)) res = FR_DENIED;
+        // keep cached blocks in sync (write through)
+        for (u32 i = 0; bdri_cache && (i < BDRI_CACHE_BLOCKS); i++) {
+            BDRICacheBlock* block = bdri_cache_block + i;
+            if ((block->offset == (u32) -1) || (block->offset >= ofs + btw) ||
+                (block->offset + bdri_cache_block_size <= ofs)) continue;
+            if (res != FR_OK) {
+                block->offset = (u32) -1;
+                continue;
+            }
+            UINT start = max(ofs, block->offset);
+            UINT end = min(ofs + btw, block->offset + bdri_cache_block_size);
+            memcpy(bdri_cache + (i * bdri_cache_block_size) + (start - block->offset),
+                (const u8*) buf + (start - ofs), end - start);
+        }
         return res;
     } else return FR_DENIED;
 }
@@ -130,6 +232,8 @@ static u32 GetBDRIEntrySize(const BDRIFsHeader* fs_header, const u32 fs_header_o
     if ((fs_header->info_offset != 0x20) || (fs_header->fat_entry_count != fs_header->data_block_count)) // Could be more thorough
         return 1;
 
+    BDRISetupCache(fs_header->data_block_size);
+
     const u32 data_offset = fs_header_offset + fs_header->data_offset;
     const u32 fet_offset = data_offset + fs_header->fet_start_block * fs_header->data_block_size;
     const u32 fht_offset = fs_header_offset + fs_header->fht_offset;
@@ -159,44 +263,15 @@ static u32 GetBDRIEntrySize(const BDRIFsHeader* fs_header, const u32 fs_header_o
     return 0;
 }
 
-static u32 ReadBDRIEntry(const BDRIFsHeader* fs_header, const u32 fs_header_offset, const u8* title_id, u8* entry, const u32 expected_size) {
-    if ((fs_header->info_offset != 0x20) || (fs_header->fat_entry_count != fs_header->data_block_count)) // Could be more thorough
-        return 1;
-
+static u32 ReadBDRIEntryData(const BDRIFsHeader* fs_header, const u32 fs_header_offset, const TdbFileEntry* file_entry, u8* entry) {
     const u32 data_offset = fs_header_offset + fs_header->data_offset;
-    const u32 fet_offset = data_offset + fs_header->fet_start_block * fs_header->data_block_size;
-    const u32 fht_offset = fs_header_offset + fs_header->fht_offset;
     const u32 fat_offset = fs_header_offset + fs_header->fat_offset;
 
-    u32 index = 0;
-    TdbFileEntry file_entry;
-    u64 tid_be = getbe64(title_id);
-    u8* title_id_be = (u8*) &tid_be;
-    const u32 hash_bucket = GetHashBucket(title_id_be, 1, fs_header->fht_bucket_count);
-
-    if (BDRIRead(fht_offset + hash_bucket * sizeof(u32), sizeof(u32), &(file_entry.hash_bucket_next_index)) != FR_OK)
-        return 1;
-
-    // Find the file entry for the tid specified, fail if it doesn't exist
-    do {
-        if (file_entry.hash_bucket_next_index == 0)
-            return 1;
-
-        index = file_entry.hash_bucket_next_index;
-
-        if (BDRIRead(fet_offset + index * sizeof(TdbFileEntry), sizeof(TdbFileEntry), &file_entry) != FR_OK)
-            return 1;
-    } while (memcmp(title_id_be, file_entry.title_id, 8) != 0);
-
-    if (expected_size && (file_entry.size != expected_size))
-        return 1;
-
-    index = file_entry.start_block_index + 1; // FAT entry index
-
+    u32 index = file_entry->start_block_index + 1; // FAT entry index
     u32 bytes_read = 0;
     u32 fat_entry[2];
 
-    while (bytes_read < file_entry.size) { // Read the full entry, walking the FAT node chain
+    while (bytes_read < file_entry->size) { // Read the full entry, walking the FAT node chain
         u32 read_start = index - 1; // Data region block index
         u32 read_count = 0;
 
@@ -222,7 +297,7 @@ static u32 ReadBDRIEntry(const BDRIFsHeader* fs_header, const u32 fs_header_offs
 
         index = next_index;
 
-        u32 btr = min(file_entry.size - bytes_read, read_count * fs_header->data_block_size);
+        u32 btr = min(file_entry->size - bytes_read, read_count * fs_header->data_block_size);
         if (entry && (BDRIRead(data_offset + read_start * fs_header->data_block_size, btr, entry + bytes_read) != FR_OK))
             return 1;
 
@@ -232,10 +307,48 @@ static u32 ReadBDRIEntry(const BDRIFsHeader* fs_header, const u32 fs_header_offs
     return 0;
 }
 
+static u32 ReadBDRIEntry(const BDRIFsHeader* fs_header, const u32 fs_header_offset, const u8* title_id, u8* entry, const u32 expected_size) {
+    if ((fs_header->info_offset != 0x20) || (fs_header->fat_entry_count != fs_header->data_block_count)) // Could be more thorough
+        return 1;
+
+    BDRISetupCache(fs_header->data_block_size);
+
+    const u32 data_offset = fs_header_offset + fs_header->data_offset;
+    const u32 fet_offset = data_offset + fs_header->fet_start_block * fs_header->data_block_size;
+    const u32 fht_offset = fs_header_offset + fs_header->fht_offset;
+
+    u32 index = 0;
+    TdbFileEntry file_entry;
+    u64 tid_be = getbe64(title_id);
+    u8* title_id_be = (u8*) &tid_be;
+    const u32 hash_bucket = GetHashBucket(title_id_be, 1, fs_header->fht_bucket_count);
+
+    if (BDRIRead(fht_offset + hash_bucket * sizeof(u32), sizeof(u32), &(file_entry.hash_bucket_next_index)) != FR_OK)
+        return 1;
+
+    // Find the file entry for the tid specified, fail if it doesn't exist
+    do {
+        if (file_entry.hash_bucket_next_index == 0)
+            return 1;
+
+        index = file_entry.hash_bucket_next_index;
+
+        if (BDRIRead(fet_offset + index * sizeof(TdbFileEntry), sizeof(TdbFileEntry), &file_entry) != FR_OK)
+            return 1;
+    } while (memcmp(title_id_be, file_entry.title_id, 8) != 0);
+
+    if (expected_size && (file_entry.size != expected_size))
+        return 1;
+
+    return ReadBDRIEntryData(fs_header, fs_header_offset, &file_entry, entry);
+}
+
 static u32 RemoveBDRIEntry(const BDRIFsHeader* fs_header, const u32 fs_header_offset, const u8* title_id) {
     if ((fs_header->info_offset != 0x20) || (fs_header->fat_entry_count != fs_header->data_block_count)) // Could be more thorough
         return 1;
 
+    BDRISetupCache(fs_header->data_block_size);
+
     const u32 data_offset = fs_header_offset + fs_header->data_offset;
     const u32 det_offset = data_offset + fs_header->det_start_block * fs_header->data_block_size;
     const u32 fet_offset = data_offset + fs_header->fet_start_block * fs_header->data_block_size;
@@ -339,6 +452,8 @@ static u32 AddBDRIEntry(const BDRIFsHeader* fs_header, const u32 fs_header_offse
     if ((fs_header->info_offset != 0x20) || (fs_header->fat_entry_count != fs_header->data_block_count)) // Could be more thorough
         return 1;
 
+    BDRISetupCache(fs_header->data_block_size);
+
     if (!entry || !size)
         return 1;
 
@@ -567,6 +682,8 @@ static u32 GetNumBDRIEntries(const BDRIFsHeader* fs_header, const u32 fs_header_
     if ((fs_header->info_offset != 0x20) || (fs_header->fat_entry_count != fs_header->data_block_count)) // Could be more thorough
         return 0;
 
+    BDRISetupCache(fs_header->data_block_size);
+
     const u32 data_offset = fs_header_offset + fs_header->data_offset;
     const u32 det_offset = data_offset + fs_header->det_start_block * fs_header->data_block_size;
     const u32 fet_offset = data_offset + fs_header->fet_start_block * fs_header->data_block_size;
@@ -591,6 +708,8 @@ static u32 ListBDRIEntryTitleIDs(const BDRIFsHeader* fs_header, const u32 fs_hea
     if ((fs_header->info_offset != 0x20) || (fs_header->fat_entry_count != fs_header->data_block_count))
         return 0;
 
+    BDRISetupCache(fs_header->data_block_size);
+
     const u32 data_offset = fs_header_offset + fs_header->data_offset;
     const u32 det_offset = data_offset + fs_header->det_start_block * fs_header->data_block_size;
     const u32 fet_offset = data_offset + fs_header->fet_start_block * fs_header->data_block_size;
@@ -618,26 +737,89 @@ static u32 ListBDRIEntryTitleIDs(const BDRIFsHeader* fs_header, const u32 fs_hea
     return 0;
 }
 
+static u32 EnumerateBDRIEntries(const BDRIFsHeader* fs_header, const u32 fs_header_offset,
+    bool (*handler)(const u8* title_id, u8* entry, u32 size, void* data), void* data) {
+    if ((fs_header->info_offset != 0x20) || (fs_header->fat_entry_count != fs_header->data_block_count))
+        return 1;
+
+    BDRISetupCache(fs_header->data_block_size);
+
+    const u32 data_offset = fs_header_offset + fs_header->data_offset;
+    const u32 det_offset = data_offset + fs_header->det_start_block * fs_header->data_block_size;
+    const u32 fet_offset = data_offset + fs_header->fet_start_block * fs_header->data_block_size;
+
+    TdbFileEntry file_entry;
+
+    // Read the index of the first file entry from the directory entry table
+    if (BDRIRead(det_offset + 0x2C, sizeof(u32), &(file_entry.next_sibling_index)) != FR_OK)
+        return 1;
+
+    // Walk the sibling chain once, reading each entry on the way (handler owns the entry)
+    // a valid chain can't be longer than max_file_count, anything else is a loop
+    for (u32 num_entries = 0; file_entry.next_sibling_index != 0; num_entries++) {
+        if (num_entries >= fs_header->max_file_count)
+            return 1;
+        if (BDRIRead(fet_offset + file_entry.next_sibling_index * sizeof(TdbFileEntry), sizeof(TdbFileEntry), &file_entry) != FR_OK)
+            return 1;
+
+        u64 tid_be = getbe64(file_entry.title_id);
+        u8* entry = (file_entry.size <= 0x100000) ? (u8*) malloc(file_entry.size) : NULL;
+        if (!entry) return 1;
+
+        if (ReadBDRIEntryData(fs_header, fs_header_offset, &file_entry, entry) != 0) {
+            free(entry);
+            return 1;
+        }
+
+        if (!handler((u8*) &tid_be, entry, file_entry.size, data))
+            return 1; // stopped by handler
+    }
+
+    return 0;
+}
+
+static Ticket* TicketFromTicketEntry(TicketEntry* te, u32 entry_size) {
+    if ((entry_size < sizeof(TicketEntry) + 0x14) ||
+        (te->ticket_size != GetTicketSize(&te->ticket))) {
+        free(te);
+        return NULL;
+    }
+
+    u32 size = te->ticket_size;
+    memmove(te, &te->ticket, size); // recycle this memory, instead of allocating another
+    Ticket* tik = realloc(te, size);
+    if(!tik) tik = (Ticket*)te;
+    return tik;
+}
+
+typedef struct {
+    bool (*handler)(const u8* title_id, Ticket* ticket, void* data);
+    void* data;
+} TicketEnumInfo;
+
+static bool TicketEnumHandler(const u8* title_id, u8* entry, u32 size, void* data) {
+    TicketEnumInfo* info = (TicketEnumInfo*) data;
+    Ticket* ticket = TicketFromTicketEntry((TicketEntry*) (void*) entry, size);
+    if (!ticket) return true; // skip invalid tickets
+    return info->handler(title_id, ticket, info->data);
+}
+
 u32 GetNumTitleInfoEntries(const char* path) {
     FIL file;
     TitleDBPreHeader pre_header;
 
-    if (fvx_open(&file, path, FA_READ | FA_OPEN_EXISTING) != FR_OK)
+    if (BDRIOpen(&file, path, FA_READ | FA_OPEN_EXISTING) != FR_OK)
         return 0;
 
-    bdrifp = &file;
-
     if ((BDRIRead(0, sizeof(TitleDBPreHeader), &pre_header) != FR_OK) ||
         !CheckDBMagic((u8*) &pre_header, false)) {
-        fvx_close(bdrifp);
-        bdrifp = NULL;
+        BDRIClose();
         return 0;
     }
 
     u32 num = GetNumBDRIEntries(&(pre_header.fs_header), sizeof(TitleDBPreHeader) - sizeof(BDRIFsHeader));
 
-    fvx_close(bdrifp);
-    bdrifp = NULL;
+    BDRIClose();
     return num;
 }
 
@@ -645,22 +827,18 @@ u32 GetNumTickets(const char* path) {
     FIL file;
     TickDBPreHeader pre_header;
 
-    if (fvx_open(&file, path, FA_READ | FA_OPEN_EXISTING) != FR_OK)
+    if (BDRIOpen(&file, path, FA_READ | FA_OPEN_EXISTING) != FR_OK)
         return 0;
 
-    bdrifp = &file;
-
     if ((BDRIRead(0, sizeof(TickDBPreHeader), &pre_header) != FR_OK) ||
         !CheckDBMagic((u8*) &pre_header, true)) {
-        fvx_close(bdrifp);
-        bdrifp = NULL;
+        BDRIClose();
         return 0;
     }
 
     u32 num = GetNumBDRIEntries(&(pre_header.fs_header), sizeof(TickDBPreHeader) - sizeof(BDRIFsHeader));
 
-    fvx_close(bdrifp);
-    bdrifp = NULL;
+    BDRIClose();
     return num;
 }
 
@@ -668,21 +846,17 @@ u32 ListTitleInfoEntryTitleIDs(const char* path, u8* title_ids, u32 max_title_id
     FIL file;
     TitleDBPreHeader pre_header;
 
-    if (fvx_open(&file, path, FA_READ | FA_OPEN_EXISTING) != FR_OK)
+    if (BDRIOpen(&file, path, FA_READ | FA_OPEN_EXISTING) != FR_OK)
         return 1;
 
-    bdrifp = &file;
-
     if ((BDRIRead(0, sizeof(TitleDBPreHeader), &pre_header) != FR_OK) ||
         !CheckDBMagic((u8*) &pre_header, false) ||
         (ListBDRIEntryTitleIDs(&(pre_header.fs_header), sizeof(TitleDBPreHeader) - sizeof(BDRIFsHeader), title_ids, max_title_ids) != 0)) {
-        fvx_close(bdrifp);
-        bdrifp = NULL;
+        BDRIClose();
         return 1;
     }
 
-    fvx_close(bdrifp);
-    bdrifp = NULL;
+    BDRIClose();
     return 0;
 }
 
@@ -690,21 +864,17 @@ u32 ListTicketTitleIDs(const char* path, u8* title_ids, u32 max_title_ids) {
     FIL file;
     TickDBPreHeader pre_header;
 
-    if (fvx_open(&file, path, FA_READ | FA_OPEN_EXISTING) != FR_OK)
+    if (BDRIOpen(&file, path, FA_READ | FA_OPEN_EXISTING) != FR_OK)
         return 1;
 
-    bdrifp = &file;
-
     if ((BDRIRead(0, sizeof(TickDBPreHeader), &pre_header) != FR_OK) ||
         !CheckDBMagic((u8*) &pre_header, true) ||
         (ListBDRIEntryTitleIDs(&(pre_header.fs_header), sizeof(TickDBPreHeader) - sizeof(BDRIFsHeader), title_ids, max_title_ids) != 0)) {
-        fvx_close(bdrifp);
-        bdrifp = NULL;
+        BDRIClose();
         return 1;
     }
 
-    fvx_close(bdrifp);
-    bdrifp = NULL;
+    BDRIClose();
     return 0;
 }
 
@@ -712,22 +882,18 @@ u32 ReadTitleInfoEntryFromDB(const char* path, const u8* title_id, TitleInfoEntr
     FIL file;
     TitleDBPreHeader pre_header;
 
-    if (fvx_open(&file, path, FA_READ | FA_OPEN_EXISTING) != FR_OK)
+    if (BDRIOpen(&file, path, FA_READ | FA_OPEN_EXISTING) != FR_OK)
         return 1;
 
-    bdrifp = &file;
-
     if ((BDRIRead(0, sizeof(TitleDBPreHeader), &pre_header) != FR_OK) ||
         !CheckDBMagic((u8*) &pre_header, false) ||
         (ReadBDRIEntry(&(pre_header.fs_header), sizeof(TitleDBPreHeader) - sizeof(BDRIFsHeader), title_id, (u8*) tie,
             sizeof(TitleInfoEntry)) != 0)) {
-        fvx_close(bdrifp);
-        bdrifp = NULL;
+        BDRIClose();
         return 1;
     }
 
-    fvx_close(bdrifp);
-    bdrifp = NULL;
+    BDRIClose();
     return 0;
 }
 
@@ -738,11 +904,9 @@ u32 ReadTicketFromDB(const char* path, const u8* title_id, Ticket** ticket) {
     u32 entry_size;
 
     *ticket = NULL;
-    if (fvx_open(&file, path, FA_READ | FA_OPEN_EXISTING) != FR_OK)
+    if (BDRIOpen(&file, path, FA_READ | FA_OPEN_EXISTING) != FR_OK)
         return 1;
 
-    bdrifp = &file;
-
     if ((BDRIRead(0, sizeof(TickDBPreHeader), &pre_header) != FR_OK) ||
         !CheckDBMagic((u8*) &pre_header, true) ||
         (GetBDRIEntrySize(&(pre_header.fs_header), sizeof(TickDBPreHeader) - sizeof(BDRIFsHeader), title_id, &entry_size) != 0) ||
@@ -751,29 +915,37 @@ u32 ReadTicketFromDB(const char* path, const u8* title_id, Ticket** ticket) {
         (ReadBDRIEntry(&(pre_header.fs_header), sizeof(TickDBPreHeader) - sizeof(BDRIFsHeader), title_id, (u8*) te,
             entry_size) != 0)) {
         free(te); // if allocated
-        fvx_close(bdrifp);
-        bdrifp = NULL;
+        BDRIClose();
         return 1;
     }
 
-    fvx_close(bdrifp);
-    bdrifp = NULL;
+    BDRIClose();
 
-    if (te->ticket_size != GetTicketSize(&te->ticket)) {
-        free(te);
+    Ticket* tik = TicketFromTicketEntry(te, entry_size);
+    if (!tik) return 1;
+
+    if (ticket) *ticket = tik;
+    else free(tik);
+    return 0;
+}
+
+u32 EnumerateTicketsInDB(const char* path, bool (*handler)(const u8* title_id, Ticket* ticket, void* data), void* data) {
+    FIL file;
+    TickDBPreHeader pre_header;
+    TicketEnumInfo info = { handler, data };
+
+    if (BDRIOpen(&file, path, FA_READ | FA_OPEN_EXISTING) != FR_OK)
         return 1;
-    }
 
-    if (ticket) {
-        u32 size = te->ticket_size;
-        memmove(te, &te->ticket, size); // recycle this memory, instead of allocating another
-        Ticket* tik = realloc(te, size);
-        if(!tik) tik = (Ticket*)te;
-        *ticket = tik;
-        return 0;
+    if ((BDRIRead(0, sizeof(TickDBPreHeader), &pre_header) != FR_OK) ||
+        !CheckDBMagic((u8*) &pre_header, true) ||
+        (EnumerateBDRIEntries(&(pre_header.fs_header), sizeof(TickDBPreHeader) - sizeof(BDRIFsHeader),
+            TicketEnumHandler, &info) != 0)) {
+        BDRIClose();
+        return 1;
     }
 
-    free(te);
+    BDRIClose();
     return 0;
 }
 
@@ -781,21 +953,17 @@ u32 RemoveTitleInfoEntryFromDB(const char* path, const u8* title_id) {
     FIL file;
     TitleDBPreHeader pre_header;
 
-    if (fvx_open(&file, path, FA_READ | FA_WRITE | FA_OPEN_EXISTING) != FR_OK)
+    if (BDRIOpen(&file, path, FA_READ | FA_WRITE | FA_OPEN_EXISTING) != FR_OK)
         return 1;
 
-    bdrifp = &file;
-
     if ((BDRIRead(0, sizeof(TitleDBPreHeader), &pre_header) != FR_OK) ||
         !CheckDBMagic((u8*) &pre_header, false) ||
         (RemoveBDRIEntry(&(pre_header.fs_header), sizeof(TitleDBPreHeader) - sizeof(BDRIFsHeader), title_id) != 0)) {
-        fvx_close(bdrifp);
-        bdrifp = NULL;
+        BDRIClose();
         return 1;
     }
 
-    fvx_close(bdrifp);
-    bdrifp = NULL;
+    BDRIClose();
     return 0;
 }
 
@@ -803,21 +971,17 @@ u32 RemoveTicketFromDB(const char* path, const u8* title_id) {
     FIL file;
     TickDBPreHeader pre_header;
 
-    if (fvx_open(&file, path, FA_READ | FA_WRITE | FA_OPEN_EXISTING) != FR_OK)
+    if (BDRIOpen(&file, path, FA_READ | FA_WRITE | FA_OPEN_EXISTING) != FR_OK)
         return 1;
 
-    bdrifp = &file;
-
     if ((BDRIRead(0, sizeof(TickDBPreHeader), &pre_header) != FR_OK) ||
         !CheckDBMagic((u8*) &pre_header, true) ||
         (RemoveBDRIEntry(&(pre_header.fs_header), sizeof(TickDBPreHeader) - sizeof(BDRIFsHeader), title_id) != 0)) {
-        fvx_close(bdrifp);
-        bdrifp = NULL;
+        BDRIClose();
         return 1;
     }
 
-    fvx_close(&file);
-    bdrifp = NULL;
+    BDRIClose();
     return 0;
 }
 
@@ -825,22 +989,18 @@ u32 AddTitleInfoEntryToDB(const char* path, const u8* title_id, const TitleInfoE
     FIL file;
     TitleDBPreHeader pre_header;
 
-    if (fvx_open(&file, path, FA_READ | FA_WRITE | FA_OPEN_EXISTING) != FR_OK)
+    if (BDRIOpen(&file, path, FA_READ | FA_WRITE | FA_OPEN_EXISTING) != FR_OK)
         return 1;
 
-    bdrifp = &file;
-
     if ((BDRIRead(0, sizeof(TitleDBPreHeader), &pre_header) != FR_OK) ||
         !CheckDBMagic((u8*) &pre_header, false) ||
         (AddBDRIEntry(&(pre_header.fs_header), sizeof(TitleDBPreHeader) - sizeof(BDRIFsHeader), title_id,
             (const u8*) tie, sizeof(TitleInfoEntry), replace) != 0)) {
-        fvx_close(bdrifp);
-        bdrifp = NULL;
+        BDRIClose();
         return 1;
     }
 
-    fvx_close(bdrifp);
-    bdrifp = NULL;
+    BDRIClose();
     return 0;
 }
 
@@ -857,25 +1017,21 @@ u32 AddTicketToDB(const char* path, const u8* title_id, const Ticket* ticket, bo
     te->unknown = 1;
     te->ticket_size = GetTicketSize(ticket);
     memcpy(&te->ticket, ticket, te->ticket_size);
-    if (fvx_open(&file, path, FA_READ | FA_WRITE | FA_OPEN_EXISTING) != FR_OK) {
+    if (BDRIOpen(&file, path, FA_READ | FA_WRITE | FA_OPEN_EXISTING) != FR_OK) {
         free(te);
         return 1;
     }
 
-    bdrifp = &file;
-
     if ((BDRIRead(0, sizeof(TickDBPreHeader), &pre_header) != FR_OK) ||
         !CheckDBMagic((u8*) &pre_header, true) ||
         (AddBDRIEntry(&(pre_header.fs_header), sizeof(TickDBPreHeader) - sizeof(BDRIFsHeader), title_id,
             (const u8*) te, entry_size, replace) != 0)) {
         free(te);
-        fvx_close(bdrifp);
-        bdrifp = NULL;
+        BDRIClose();
         return 1;
     }
 
     free(te);
-    fvx_close(bdrifp);
-    bdrifp = NULL;
+    BDRIClose();
     return 0;
 }
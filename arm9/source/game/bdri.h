@@ -12,6 +12,8 @@ u32 ListTitleInfoEntryTitleIDs(const char* path, u8* title_ids, u32 max_title_id
 u32 ListTicketTitleIDs(const char* path, u8* title_ids, u32 max_title_ids);
 u32 ReadTitleInfoEntryFromDB(const char* path, const u8* title_id, TitleInfoEntry* tie);
 u32 ReadTicketFromDB(const char* path, const u8* title_id, Ticket** ticket);
+// calls handler for each ticket (handler owns it), aborts (returns 1) when handler returns false
+u32 EnumerateTicketsInDB(const char* path, bool (*handler)(const u8* title_id, Ticket* ticket, void* data), void* data);
 u32 RemoveTitleInfoEntryFromDB(const char* path, const u8* title_id);
 u32 RemoveTicketFromDB(const char* path, const u8* title_id);
 u32 AddTitleInfoEntryToDB(const char* path, const u8* title_id, const TitleInfoEntry* tie, bool replace);
@@ -30,6 +30,8 @@
 #define BEAT_VLIBUFSZ	(8)
 #define BEAT_MAXPATH	(256)
 #define BEAT_FILEBUFSZ	(256 * 1024)
+#define BEAT_READBUFSZ	(32 * 1024) // read-ahead for patch / source
+#define BEAT_WRITEBUFSZ	(64 * 1024) // write-behind for target
 
 #define BEAT_RANGE(c, i)	((c)->ranges[1][i] - (c)->ranges[0][i])
 #define BEAT_UPDATEDELAYMS	(1000 / 4)
@@ -103,9 +105,17 @@ static const u8 bps_chksumoffs[BEAT_FILENUM] = {
 };
 static const u8 bpm_signature[] = { 'B', 'P', 'M', '1' };
 
+/** BEAT BUFFERED STREAM */
+typedef struct {
+	u8 *buf;
+	size_t off, len; // buffered range, relative to the start of the file range
+} BEAT_Stream;
+
 /** BEAT STATE STORAGE */
 typedef struct {
 	u8 *copybuf;
+	u8 *streambuf;
+	BEAT_Stream stream[BEAT_FILENUM];
 	size_t foff[BEAT_FILENUM], eoal_offset;
 	size_t ranges[2][BEAT_FILENUM];
 	u32 ocrc; // Output crc
@@ -158,32 +168,107 @@ static const char *BEAT_ErrString(int error)
 	}
 }
 
-static int BEAT_Read(BEAT_Context *ctx, int id, void *out, size_t len, int fwd)
-{ // Read up to `len` bytes from the context file `id` to the `out` buffer
+static int BEAT_InitStreams(BEAT_Context *ctx)
+{ // Set up the read-ahead (patch, source) and write-behind (target) buffers
+	ctx->streambuf = malloc((2 * BEAT_READBUFSZ) + BEAT_WRITEBUFSZ);
+	if (ctx->streambuf == NULL) return BEAT_OUT_OF_MEMORY;
+	ctx->stream[BEAT_PF].buf = ctx->streambuf;
+	ctx->stream[BEAT_IF].buf = ctx->streambuf + BEAT_READBUFSZ;
+	ctx->stream[BEAT_OF].buf = ctx->streambuf + (2 * BEAT_READBUFSZ);
+	return BEAT_OK;
+}
+
+static int BEAT_RawRead(BEAT_Context *ctx, int id, size_t pos, void *out, size_t len)
+{ // Unbuffered read, only seeks if the file pointer is not already there
 	UINT br;
 	FRESULT res;
-	if ((len + ctx->foff[id]) > BEAT_RANGE(ctx, id))
+	FSIZE_t abspos = ctx->ranges[0][id] + pos;
+	if ((fvx_tell(&ctx->file[id]) != abspos) &&
+		(fvx_lseek(&ctx->file[id], abspos) != FR_OK)) return BEAT_IO_ERROR;
+	res = fvx_read(&ctx->file[id], out, len, &br);
+	return (res == FR_OK && br == len) ? BEAT_OK : BEAT_IO_ERROR;
+}
+
+static int BEAT_RawWrite(BEAT_Context *ctx, size_t pos, const void *in, size_t len)
+{ // Unbuffered write to BEAT_OF
+	UINT bw;
+	FRESULT res;
+	FSIZE_t abspos = ctx->ranges[0][BEAT_OF] + pos;
+	if ((fvx_tell(&ctx->file[BEAT_OF]) != abspos) &&
+		(fvx_lseek(&ctx->file[BEAT_OF], abspos) != FR_OK)) return BEAT_IO_ERROR;
+	res = fvx_write(&ctx->file[BEAT_OF], in, len, &bw);
+	return (res == FR_OK && bw == len) ? BEAT_OK : BEAT_IO_ERROR;
+}
+
+static int BEAT_FlushOut(BEAT_Context *ctx)
+{ // Write back whatever is pending in the target buffer
+	int res;
+	BEAT_Stream *st = &ctx->stream[BEAT_OF];
+	if (st->len == 0) return BEAT_OK;
+	res = BEAT_RawWrite(ctx, st->off, st->buf, st->len);
+	st->len = 0;
+	return res;
+}
+
+static int BEAT_Read(BEAT_Context *ctx, int id, void *out, size_t len, int fwd)
+{ // Read up to `len` bytes from the context file `id` to the `out` buffer
+	int res;
+	BEAT_Stream *st = &ctx->stream[id];
+	size_t pos = ctx->foff[id]; // ALWAYS use the state offset + start range
+	if ((len + pos) > BEAT_RANGE(ctx, id))
 		return BEAT_OVERFLOW;
 
-	fvx_lseek(&ctx->file[id], BEAT_ABSPOS(ctx, id)); // ALWAYS use the state offset + start range
+	if (st->buf && (pos >= st->off) && ((pos + len) <= (st->off + st->len))) {
+		// already buffered (read-ahead or pending target data)
+		memcpy(out, st->buf + (pos - st->off), len);
+		ctx->foff[id] += len * fwd;
+		return BEAT_OK;
+	}
+
+	if (id == BEAT_OF) { // target data might still be pending
+		res = BEAT_FlushOut(ctx);
+		if (res != BEAT_OK) return res;
+	} else if (st->buf && (len <= (BEAT_READBUFSZ / 2))) { // small read, refill
+		size_t rdlen = min(BEAT_READBUFSZ, BEAT_RANGE(ctx, id) - pos);
+		st->len = 0;
+		res = BEAT_RawRead(ctx, id, pos, st->buf, rdlen);
+		if (res != BEAT_OK) return res;
+		st->off = pos;
+		st->len = rdlen;
+		memcpy(out, st->buf, len);
+		ctx->foff[id] += len * fwd;
+		return BEAT_OK;
+	}
+
 	ctx->foff[id] += len * fwd;
-	res = fvx_read(&ctx->file[id], out, len, &br);
-	return (res == FR_OK && br == len) ? BEAT_OK : BEAT_IO_ERROR;
+	return BEAT_RawRead(ctx, id, pos, out, len);
 }
 
 static int BEAT_WriteOut(BEAT_Context *ctx, const u8 *in, size_t len, int fwd)
 { // Write `len` bytes from `in` to BEAT_OF, updates the output CRC
-	UINT bw;
-	FRESULT res;
-	if ((len + ctx->foff[BEAT_OF]) > BEAT_RANGE(ctx, BEAT_OF))
+	int res;
+	BEAT_Stream *st = &ctx->stream[BEAT_OF];
+	size_t pos = ctx->foff[BEAT_OF];
+	if ((len + pos) > BEAT_RANGE(ctx, BEAT_OF))
 		return BEAT_OVERFLOW;
 
 	// Blindly assume all writes will be done linearly
 	ctx->ocrc = ~crc32_calculate(~ctx->ocrc, in, len);
-	fvx_lseek(&ctx->file[BEAT_OF], BEAT_ABSPOS(ctx, BEAT_OF));
 	ctx->foff[BEAT_OF] += len * fwd;
-	res = fvx_write(&ctx->file[BEAT_OF], in, len, &bw);
-	return (res == FR_OK && bw == len) ? BEAT_OK : BEAT_IO_ERROR;
+
+	// Small writes are collected and written back in one go
+	if (st->len && (((st->off + st->len) != pos) || ((st->len + len) > BEAT_WRITEBUFSZ))) {
+		res = BEAT_FlushOut(ctx);
+		if (res != BEAT_OK) return res;
+	}
+	if (st->buf && (len < BEAT_WRITEBUFSZ)) {
+		if (st->len == 0) st->off = pos;
+		memcpy(st->buf + st->len, in, len);
+		st->len += len;
+		return BEAT_OK;
+	}
+
+	return BEAT_RawWrite(ctx, pos, in, len);
 }
 
 static void BEAT_SeekOff(BEAT_Context *ctx, int id, ssize_t offset)
@@ -221,7 +306,7 @@ static s32 BEAT_DecodeSigned(u32 val) // Extract the signed number
 static int BEAT_RunActions(BEAT_Context *ctx, const BEAT_Action *acts)
 { // Parses an action list and runs commands specified in `acts`
 	u32 vli, len;
-	int cmd, res;
+	int cmd, res = BEAT_OK;
 
 	while((res == BEAT_OK) &&
 		(ctx->foff[BEAT_PF] < (BEAT_RANGE(ctx, BEAT_PF) - ctx->eoal_offset))) {
@@ -236,12 +321,15 @@ static int BEAT_RunActions(BEAT_Context *ctx, const BEAT_Action *acts)
 		if (res != BEAT_OK) return res; // Break on error or user abort
 	}
 
-	return res;
+	return BEAT_EOAL;
 }
 
 static void BEAT_ReleaseCTX(BEAT_Context *ctx)
 { // Release any resources associated to the context
+	// best effort only, successful runs have flushed already (abort / error paths)
+	if (fvx_opened(&ctx->file[BEAT_OF])) BEAT_FlushOut(ctx);
 	free(ctx->copybuf);
+	free(ctx->streambuf);
 	for (int i = 0; i < BEAT_FILENUM; i++) {
 		if (fvx_opened(&ctx->file[i])) fvx_close(&ctx->file[i]);
 	}
@@ -266,6 +354,8 @@ static int BPS_InitCTX_Advanced(BEAT_Context *ctx, const char *bps_path, const c
 	// Clear stackbuf
 	memset(ctx, 0, sizeof(*ctx));
 	ctx->eoal_offset = 12;
+	res = BEAT_InitStreams(ctx);
+	if (res != BEAT_OK) return res;
 
 	if (end == 0) {
 		start = 0;
@@ -454,6 +544,7 @@ static int BPS_RunActions(BEAT_Context *ctx)
 	};
 	int res = BEAT_RunActions(ctx, BPS_Actions);
 	if (res == BEAT_ABORTED) return BEAT_ABORTED;
+	if ((res == BEAT_EOAL) && (BEAT_FlushOut(ctx) != BEAT_OK)) return BEAT_IO_ERROR;
 	if (res == BEAT_EOAL) // Verify hashes
 		return (ctx->ocrc == ctx->xocrc) ? BEAT_OK : BEAT_BADOUTPUT;
 	return res; // some kind of error
@@ -466,7 +557,10 @@ static int BPM_OpenFile(BEAT_Context *ctx, int id, const char *path, size_t max_
 {
 	FRESULT res;
 
+	if ((id == BEAT_OF) && fvx_opened(&ctx->file[id]) &&
+		(BEAT_FlushOut(ctx) != BEAT_OK)) return BEAT_IO_ERROR;
 	if (fvx_opened(&ctx->file[id])) fvx_close(&ctx->file[id]);
+	ctx->stream[id].len = 0; // drop buffered data of the old file
 	res = fvx_open(&ctx->file[id], path, max_sz ? BEAT_RWCREATE : BEAT_READONLY);
 	if (res != FR_OK) return BEAT_IO_ERROR;
 
@@ -497,6 +591,8 @@ static int BPM_InitCTX(BEAT_Context *ctx, const char *bpm_path, const char *src_
 	ctx->source_dir = src_dir;
 	ctx->target_dir = dst_dir;
 	ctx->eoal_offset = 4;
+	res = BEAT_InitStreams(ctx);
+	if (res != BEAT_OK) return res;
 
 	chksum = crc32_calculate_from_file(bpm_path, 0, fs_size(bpm_path) - 4);
 	res = BPM_OpenFile(ctx, BEAT_PF, bpm_path, 0);
@@ -648,6 +744,7 @@ static int BPM_RunActions(BEAT_Context *ctx)
 	};
 	int res = BEAT_RunActions(ctx, BPM_Actions);
 	if (res == BEAT_ABORTED) return BEAT_ABORTED;
+	if ((res == BEAT_EOAL) && (BEAT_FlushOut(ctx) != BEAT_OK)) return BEAT_IO_ERROR; // last target file
 	if (res == BEAT_EOAL) return BEAT_OK;
 	return res;
 }
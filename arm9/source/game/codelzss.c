@@ -44,11 +44,16 @@ u32 DecompressCodeLzss(u8* code, u32* code_size, u32 max_size) {
     u8* ptr_out = data_end;
 
     // main decompression loop
+    u32 next_prog = 0;
     while ((ptr_in > comp_start) && (ptr_out > comp_start)) {
-        if (!ShowProgress(data_end - ptr_out, data_end - data_start, "Decompressing .code...")) {
-            if (ShowPrompt(true, "Decompressing .code...\nB button detected. Cancel?")) return 1;
-            ShowProgress(0, data_end - data_start, "Decompressing .code...");
-            ShowProgress(data_end - ptr_out, data_end - data_start, "Decompressing .code...");
+        // progress is only updated every 16kB of output
+        if ((u32) (data_end - ptr_out) >= next_prog) {
+            if (!ShowProgress(data_end - ptr_out, data_end - data_start, "Decompressing .code...")) {
+                if (ShowPrompt(true, "Decompressing .code...\nB button detected. Cancel?")) return 1;
+                ShowProgress(0, data_end - data_start, "Decompressing .code...");
+                ShowProgress(data_end - ptr_out, data_end - data_start, "Decompressing .code...");
+            }
+            next_prog = (data_end - ptr_out) + 0x4000;
         }
 
         // sanity check
@@ -56,6 +61,38 @@ u32 DecompressCodeLzss(u8* code, u32* code_size, u32 max_size) {
 
         // read and process control byte
         u8 ctrlbyte = *(--ptr_in);
+
+        // fast path, far enough from the start for a full group (8 segments of 2 -> 18 bytes)
+        if ((ptr_in - comp_start >= 8 * 2) && (ptr_out - comp_start >= 8 * 18)) {
+            if (!ctrlbyte) { // 8 literals
+                ptr_in -= 8;
+                ptr_out -= 8;
+                memmove(ptr_out, ptr_in, 8);
+                continue;
+            }
+            for (u32 i = 0; i < 8; i++, ctrlbyte <<= 1) {
+                if (!(ctrlbyte & 0x80)) {
+                    *(--ptr_out) = *(--ptr_in);
+                    continue;
+                }
+
+                ptr_in -= 2;
+                u16 seg_code = getle16(ptr_in);
+                u32 seg_off = CODE_SEG_OFFSET(seg_code);
+                u32 seg_len = CODE_SEG_SIZE(seg_code);
+                if (ptr_out + seg_off >= data_end) return 1;
+
+                // source is ptr_out + seg_off down to ptr_out + seg_off + 1 - seg_len
+                ptr_out -= seg_len;
+                if (seg_off + 1 >= seg_len) {
+                    memcpy(ptr_out, ptr_out + seg_off + 1, seg_len);
+                } else for (u32 c = seg_len; c > 0; c--) {
+                    ptr_out[c - 1] = ptr_out[c + seg_off];
+                }
+            }
+            continue;
+        }
+
         for (int i = 7; i >= 0; i--) {
             // end conditions met?
             if ((ptr_in <= comp_start) || (ptr_out <= comp_start))
@@ -64,9 +101,9 @@ u32 DecompressCodeLzss(u8* code, u32* code_size, u32 max_size) {
             // process control byte
             if ((ctrlbyte >> i) & 0x1) {
                 // control bit set, read segment code
+                if (ptr_in - 2 < comp_start) return 1; // corrupted code
                 ptr_in -= 2;
                 u16 seg_code = getle16(ptr_in);
-                if (ptr_in < comp_start) return 1; // corrupted code
                 u32 seg_off = CODE_SEG_OFFSET(seg_code);
                 u32 seg_len = CODE_SEG_SIZE(seg_code);
 
@@ -99,126 +136,69 @@ u32 DecompressCodeLzss(u8* code, u32* code_size, u32 max_size) {
     return 0;
 }
 
-// see https://github.com/dnasdw/3dstool/blob/master/src/backwardlz77.cpp (GPLv3)
+// compressed stream layout follows https://github.com/dnasdw/3dstool/blob/master/src/backwardlz77.cpp (GPLv3)
+// matching is done via hash chains over the 3 byte prefix (going backwards) of each position
+#ifndef CODE_LZSS_CHAIN_DEPTH
+#define CODE_LZSS_CHAIN_DEPTH   1024 // max number of candidates checked per position
+#endif
+#ifndef CODE_LZSS_LAZY
+#define CODE_LZSS_LAZY          1 // check if a literal followed by a match would be better
+#endif
+
+#define CODE_LZSS_MIN_MATCH     3
+#define CODE_LZSS_MAX_MATCH     (0xF + 3)
+#define CODE_LZSS_MIN_DIST      3
+#define CODE_LZSS_MAX_DIST      (0xFFF + 3)
+#define CODE_LZSS_HASH_BITS     12
+#define CODE_LZSS_PREV_SIZE     0x2000 // power of two, > CODE_LZSS_MAX_DIST
+
 typedef struct {
-    u16 WindowPos;
-    u16 WindowLen;
-    s16* OffsetTable;
-    s16* ReversedOffsetTable;
-    s16* ByteTable;
-    s16* EndTable;
-} sCompressInfo;
-
-void initTable(sCompressInfo* a_pInfo, void* a_pWork) {
-    a_pInfo->WindowPos = 0;
-    a_pInfo->WindowLen = 0;
-    a_pInfo->OffsetTable = (s16*)(a_pWork);
-    a_pInfo->ReversedOffsetTable = (s16*)(a_pWork) + 4098;
-    a_pInfo->ByteTable = (s16*)(a_pWork) + 4098 + 4098;
-    a_pInfo->EndTable = (s16*)(a_pWork) + 4098 + 4098 + 256;
-
-    for (int i = 0; i < 256; i++) {
-        a_pInfo->ByteTable[i] = -1;
-        a_pInfo->EndTable[i] = -1;
-    }
+    u32 head[1 << CODE_LZSS_HASH_BITS]; // most recent position per hash, 0 if none
+    u32 prev[CODE_LZSS_PREV_SIZE]; // next (older) position with the same hash
+} CodeLzssMatcher;
+
+// position p stands for the bytes right below it, p[-1], p[-2], p[-3]
+static inline u32 HashCodeLzss(const u8* p) {
+    u32 v = ((u32) p[-1] << 16) | ((u32) p[-2] << 8) | p[-3];
+    return (v * 2654435761U) >> (32 - CODE_LZSS_HASH_BITS);
 }
 
-int search(sCompressInfo* a_pInfo, const u8* a_pSrc, int* a_nOffset, int a_nMaxSize) {
-    if (a_nMaxSize < 3) {
-        return 0;
-    }
-
-    const u8* pSearch = NULL;
-    int nSize = 2;
-    const u16 uWindowPos = a_pInfo->WindowPos;
-    const u16 uWindowLen = a_pInfo->WindowLen;
-    s16* pReversedOffsetTable = a_pInfo->ReversedOffsetTable;
-
-    for (s16 nOffset = a_pInfo->EndTable[*(a_pSrc - 1)]; nOffset != -1; nOffset = pReversedOffsetTable[nOffset]) {
-        if (nOffset < uWindowPos) {
-            pSearch = a_pSrc + uWindowPos - nOffset;
-        } else {
-            pSearch = a_pSrc + uWindowLen + uWindowPos - nOffset;
-        }
-
-        if (pSearch - a_pSrc < 3) {
-            continue;
-        }
-
-        if (*(pSearch - 2) != *(a_pSrc - 2) || *(pSearch - 3) != *(a_pSrc - 3)) {
-            continue;
-        }
-
-        int nMaxSize = (int)((s64)min(a_nMaxSize, pSearch - a_pSrc));
-        int nCurrentSize = 3;
-
-        while (nCurrentSize < nMaxSize && *(pSearch - nCurrentSize - 1) == *(a_pSrc - nCurrentSize - 1)) {
-            nCurrentSize++;
-        }
-
-        if (nCurrentSize > nSize) {
-            nSize = nCurrentSize;
-            *a_nOffset = (int)(pSearch - a_pSrc);
-            if (nSize == a_nMaxSize) {
-                break;
-            }
-        }
-    }
-
-    if (nSize < 3) {
-        return 0;
-    }
-
-    return nSize;
+static inline void InsertCodeLzss(CodeLzssMatcher* m, const u8* data, u32 pos) {
+    if (pos < CODE_LZSS_MIN_MATCH) return;
+    u32 h = HashCodeLzss(data + pos);
+    m->prev[pos & (CODE_LZSS_PREV_SIZE - 1)] = m->head[h];
+    m->head[h] = pos;
 }
 
-void slideByte(sCompressInfo* a_pInfo, const u8* a_pSrc) {
-    u8 uInData = *(a_pSrc - 1);
-    u16 uInsertOffset = 0;
-    const u16 uWindowPos = a_pInfo->WindowPos;
-    const u16 uWindowLen = a_pInfo->WindowLen;
-    s16* pOffsetTable = a_pInfo->OffsetTable;
-    s16* pReversedOffsetTable = a_pInfo->ReversedOffsetTable;
-    s16* pByteTable = a_pInfo->ByteTable;
-    s16* pEndTable = a_pInfo->EndTable;
-
-    if (uWindowLen == 4098) {
-        u8 uOutData = *(a_pSrc + 4097);
-
-        if ((pByteTable[uOutData] = pOffsetTable[pByteTable[uOutData]]) == -1) {
-            pEndTable[uOutData] = -1;
-        } else {
-            pReversedOffsetTable[pByteTable[uOutData]] = -1;
+static u32 FindCodeLzss(CodeLzssMatcher* m, const u8* data, u32 pos, u32* dist) {
+    const u8* src = data + pos;
+    u32 max_len = min(CODE_LZSS_MAX_MATCH, pos);
+    u32 best = 0;
+
+    if (max_len < CODE_LZSS_MIN_MATCH) return 0;
+
+    // positions in the chain only get bigger, the first one out of the window ends the search
+    u32 depth = CODE_LZSS_CHAIN_DEPTH;
+    for (u32 cand = m->head[HashCodeLzss(src)]; cand && depth; cand = m->prev[cand & (CODE_LZSS_PREV_SIZE - 1)], depth--) {
+        u32 d = cand - pos;
+        if (d > CODE_LZSS_MAX_DIST) break;
+        if (d < CODE_LZSS_MIN_DIST) continue;
+
+        // matches may not overlap the bytes they produce
+        const u8* ref = data + cand;
+        u32 len_max = min(max_len, d);
+        if ((len_max <= best) || (ref[-(int) best - 1] != src[-(int) best - 1])) continue;
+
+        u32 len = 0;
+        while ((len < len_max) && (ref[-(int) len - 1] == src[-(int) len - 1])) len++;
+        if ((len >= CODE_LZSS_MIN_MATCH) && (len > best)) {
+            best = len;
+            *dist = d;
+            if (best == max_len) break;
         }
-
-        uInsertOffset = uWindowPos;
-    } else {
-        uInsertOffset = uWindowLen;
     }
 
-    s16 nOffset = pEndTable[uInData];
-
-    if (nOffset == -1) {
-        pByteTable[uInData] = uInsertOffset;
-    } else {
-        pOffsetTable[nOffset] = uInsertOffset;
-    }
-
-    pEndTable[uInData] = uInsertOffset;
-    pOffsetTable[uInsertOffset] = -1;
-    pReversedOffsetTable[uInsertOffset] = nOffset;
-
-    if (uWindowLen == 4098) {
-        a_pInfo->WindowPos = (uWindowPos + 1) % 4098;
-    } else {
-        a_pInfo->WindowLen++;
-    }
-}
-
-static inline void slide(sCompressInfo* a_pInfo, const u8* a_pSrc, int a_nSize) {
-    for (int i = 0; i < a_nSize; i++) {
-        slideByte(a_pInfo, a_pSrc--);
-    }
+    return best;
 }
 
 s64 alignBytes(s64 a_nData, s64 a_nAlignment) {
@@ -226,46 +206,61 @@ s64 alignBytes(s64 a_nData, s64 a_nAlignment) {
 }
 
 bool CompressCodeLzss(const u8* a_pUncompressed, u32 a_uUncompressedSize, u8* a_pCompressed, u32* a_uCompressedSize) {
-    const int s_nCompressWorkSize = (4098 + 4098 + 256 + 256) * sizeof(s16);
     bool bResult = true;
 
     if (a_uUncompressedSize > sizeof(CodeLzssFooter) && *a_uCompressedSize >= a_uUncompressedSize) {
-        u8* pWork = malloc(s_nCompressWorkSize * sizeof(u8));
-        if (!pWork) return false;
+        CodeLzssMatcher* matcher = malloc(sizeof(CodeLzssMatcher));
+        if (!matcher) return false;
+        memset(matcher->head, 0, sizeof(matcher->head));
 
         do {
-            sCompressInfo info;
-            initTable(&info, pWork);
-
-            const int nMaxSize = 0xF + 3;
-            const u8* pSrc = a_pUncompressed + a_uUncompressedSize;
+            u32 pos = a_uUncompressedSize;
             u8* pDest = a_pCompressed + a_uUncompressedSize;
 
-            while (pSrc - a_pUncompressed > 0 && pDest - a_pCompressed > 0) {
-                if (!ShowProgress((u32)(a_pUncompressed + a_uUncompressedSize - pSrc), a_uUncompressedSize, "Compressing .code...")) {
+            // lookahead from the lazy check, reused for the next position
+            u32 next_len = 0;
+            u32 next_dist = 0;
+            bool next_valid = false;
+
+            while (pos > 0 && pDest - a_pCompressed > 0) {
+                if (!ShowProgress(a_uUncompressedSize - pos, a_uUncompressedSize, "Compressing .code...")) {
                     if (ShowPrompt(true, "Compressing .code...\nB button detected. Cancel?")) {
                         bResult = false;
                         break;
                     }
                     ShowProgress(0, a_uUncompressedSize, "Compressing .code...");
-                    ShowProgress((u32)(a_pUncompressed + a_uUncompressedSize - pSrc), a_uUncompressedSize, "Compressing .code...");
+                    ShowProgress(a_uUncompressedSize - pos, a_uUncompressedSize, "Compressing .code...");
                 }
 
                 u8* pFlag = --pDest;
                 *pFlag = 0;
 
                 for (int i = 0; i < 8; i++) {
-                    int nOffset = 0;
-                    int nSize = search(&info, pSrc, &nOffset, (int)((s64)min((s64)min(nMaxSize, pSrc - a_pUncompressed), a_pUncompressed + a_uUncompressedSize - pSrc)));
+                    u32 dist = 0;
+                    u32 len;
+                    if (next_valid) {
+                        len = next_len;
+                        dist = next_dist;
+                        next_valid = false;
+                    } else len = FindCodeLzss(matcher, a_pUncompressed, pos, &dist);
+
+                    #if CODE_LZSS_LAZY
+                    // a longer match one byte further is worth a literal
+                    if ((len >= CODE_LZSS_MIN_MATCH) && (len < CODE_LZSS_MAX_MATCH) && (pos > 1)) {
+                        next_len = FindCodeLzss(matcher, a_pUncompressed, pos - 1, &next_dist);
+                        next_valid = true;
+                        if (next_len > len) len = 0;
+                    }
+                    #endif
 
-                    if (nSize < 3) {
+                    if (len < CODE_LZSS_MIN_MATCH) {
                         if (pDest - a_pCompressed < 1) {
                             bResult = false;
                             break;
                         }
 
-                        slide(&info, pSrc, 1);
-                        *--pDest = *--pSrc;
+                        InsertCodeLzss(matcher, a_pUncompressed, pos);
+                        *--pDest = a_pUncompressed[--pos];
                     } else {
                         if (pDest - a_pCompressed < 2) {
                             bResult = false;
@@ -273,14 +268,15 @@ bool CompressCodeLzss(const u8* a_pUncompressed, u32 a_uUncompressedSize, u8* a_
                         }
 
                         *pFlag |= 0x80 >> i;
-                        slide(&info, pSrc, nSize);
-                        pSrc -= nSize;
-                        nSize -= 3;
-                        *--pDest = (nSize << 4 & 0xF0) | ((nOffset - 3) >> 8 & 0x0F);
-                        *--pDest = (nOffset - 3) & 0xFF;
+                        for (u32 n = 0; n < len; n++)
+                            InsertCodeLzss(matcher, a_pUncompressed, pos--);
+                        next_valid = false;
+                        len -= 3;
+                        *--pDest = (len << 4 & 0xF0) | ((dist - 3) >> 8 & 0x0F);
+                        *--pDest = (dist - 3) & 0xFF;
                     }
 
-                    if (pSrc - a_pUncompressed <= 0) {
+                    if (pos == 0) {
                         break;
                     }
                 }
@@ -297,7 +293,7 @@ bool CompressCodeLzss(const u8* a_pUncompressed, u32 a_uUncompressedSize, u8* a_
             *a_uCompressedSize = (u32)(a_pCompressed + a_uUncompressedSize - pDest);
         } while (false);
 
-        free(pWork);
+        free(matcher);
     } else {
         bResult = false;
     }
@@ -5,6 +5,10 @@
 
 #define GET_DPFS_BIT(b, lvl) (((((u32*) (void*) lvl)[b >> 5]) >> (31 - (b % 32))) & 1)
 
+#define GET_DIRTY_BIT(b, map)   (((map)[(b) >> 3] >> ((b) & 7)) & 1)
+#define SET_DIRTY_BIT(b, map)   ((map)[(b) >> 3] |= (1 << ((b) & 7)))
+#define CLEAR_DIRTY_BIT(b, map) ((map)[(b) >> 3] &= ~(1 << ((b) & 7)))
+
 typedef struct {
     u8  magic[8]; // "DISA" 0x00040000
     u32 n_partitions;
@@ -411,7 +415,7 @@ static u32 WriteDisaDiffDpfsLvl3(const DisaDiffRWInfo* info, u32 offset, u32 siz
     return size;
 }
 
-u32 FixDisaDiffPartitionHash(const DisaDiffRWInfo* info) {
+static u32 FixDisaDiffPartitionHash(const DisaDiffRWInfo* info) {
     const u32 size = info->size_table;
     u8 sha_buf[0x20];
     u8* buf;
@@ -434,81 +438,119 @@ u32 FixDisaDiffPartitionHash(const DisaDiffRWInfo* info) {
     return 0;
 }
 
-u32 FixDisaDiffIvfcLevel(const DisaDiffRWInfo* info, u32 level, u32 offset, u32 size, u32* next_offset, u32* next_size) {
-    if (level == 0)
-        return FixDisaDiffPartitionHash(info);
+u32 InitDisaDiffIvfcDirty(const DisaDiffRWInfo* info, DisaDiffIvfcDirty* dirty) {
+    u32 max_block_size = 0;
+    memset(dirty, 0x00, sizeof(DisaDiffIvfcDirty));
+
+    for (u32 level = 1; level <= 4; level++) {
+        const u32 size_ivfc_lvl = (&(info->size_ivfc_lvl1))[level - 1];
+        const u32 log_ivfc_lvl = (&(info->log_ivfc_lvl1))[level - 1];
+        const u32 n_blocks = (size_ivfc_lvl + (1 << log_ivfc_lvl) - 1) >> log_ivfc_lvl;
+        if (log_ivfc_lvl > 24) { // sanity
+            FreeDisaDiffIvfcDirty(dirty);
+            return 1;
+        }
+        dirty->n_blocks[level - 1] = n_blocks;
+        dirty->bitmap[level - 1] = (u8*) malloc((n_blocks + 7) >> 3);
+        if (!dirty->bitmap[level - 1]) {
+            FreeDisaDiffIvfcDirty(dirty);
+            return 1;
+        }
+        memset(dirty->bitmap[level - 1], 0x00, (n_blocks + 7) >> 3);
+        max_block_size = max(max_block_size, (u32) 1 << log_ivfc_lvl);
+    }
 
-    if (level > 4)
+    // one scratch buffer, used for all hashed blocks
+    dirty->scratch = (u8*) malloc(max_block_size);
+    if (!dirty->scratch) {
+        FreeDisaDiffIvfcDirty(dirty);
         return 1;
+    }
 
-    const u32 offset_ivfc_lvl = (&(info->offset_ivfc_lvl1))[level - 1];
-    const u32 size_ivfc_lvl = (&(info->size_ivfc_lvl1))[level - 1];
-    const u32 log_ivfc_lvl = (&(info->log_ivfc_lvl1))[level - 1];
-    const u32 block_size = 1 << log_ivfc_lvl;
-    u32 read_size = block_size;
-    u32 align_offset = (offset >> log_ivfc_lvl) << log_ivfc_lvl; // align starting offset
-    u32 align_size = size + offset - align_offset; // increase size by the amount starting offset decreased when aligned
+    return 0;
+}
 
-    if (level != 1) {
-        if (next_offset) *next_offset = (align_offset >> log_ivfc_lvl) * 0x20;
-        if (next_size) *next_size = ((align_size >> log_ivfc_lvl) + (((align_size % block_size) == 0) ? 0 : 1)) * 0x20;
-    }
+void FreeDisaDiffIvfcDirty(DisaDiffIvfcDirty* dirty) {
+    for (u32 i = 0; i < 4; i++)
+        if (dirty->bitmap[i]) free(dirty->bitmap[i]);
+    if (dirty->scratch) free(dirty->scratch);
+    memset(dirty, 0x00, sizeof(DisaDiffIvfcDirty));
+}
 
-    u8 sha_buf[0x20];
-    u8* buf;
+void MarkDisaDiffIvfcDirty(const DisaDiffRWInfo* info, DisaDiffIvfcDirty* dirty, u32 offset, u32 size) { // offset: offset inside IVFC lvl4
+    const u32 log_lvl4 = info->log_ivfc_lvl4;
+    if (!size || !dirty->bitmap[3]) return;
 
-    if (!(buf = malloc(block_size)))
-        return 1;
+    u32 block_end = min((offset + size - 1) >> log_lvl4, dirty->n_blocks[3] - 1);
+    for (u32 b = offset >> log_lvl4; b <= block_end; b++)
+        SET_DIRTY_BIT(b, dirty->bitmap[3]);
+    dirty->is_dirty = true;
+}
 
-    while (align_size > 0) {
-        if (align_offset + block_size > size_ivfc_lvl) {
-            memset(buf, 0, block_size);
-            read_size -= (align_offset + block_size - size_ivfc_lvl);
+static u32 FixDisaDiffIvfcDirtyLevel(const DisaDiffRWInfo* info, DisaDiffIvfcDirty* dirty, u32 level) {
+    const u32 offset_ivfc_lvl = (&(info->offset_ivfc_lvl1))[level - 1];
+    const u32 size_ivfc_lvl = (&(info->size_ivfc_lvl1))[level - 1];
+    const u32 log_ivfc_lvl = (&(info->log_ivfc_lvl1))[level - 1];
+    const u32 block_size = 1 << log_ivfc_lvl;
+    const u32 n_blocks = dirty->n_blocks[level - 1];
+    u8* bitmap = dirty->bitmap[level - 1];
+    u8* buf = dirty->scratch;
+
+    u8 sha_buf[0x20 * 16]; // hashes of a run of dirty blocks, written in one go
+    u32 run_start = 0;
+    u32 run_count = 0;
+
+    for (u32 b = 0; b <= n_blocks; b++) {
+        bool is_dirty = (b < n_blocks) && GET_DIRTY_BIT(b, bitmap);
+
+        // write out the hashes of the current run
+        if (run_count && (!is_dirty || (run_count >= 16))) {
+            const u32 hash_offset = run_start * 0x20;
+            if ((level == 1) ? (DisaDiffWrite(sha_buf, run_count * 0x20, info->offset_difi + info->offset_master_hash + hash_offset) != FR_OK) :
+                (WriteDisaDiffDpfsLvl3(info, (&(info->offset_ivfc_lvl1))[level - 2] + hash_offset, run_count * 0x20, sha_buf) != run_count * 0x20))
+                return 1;
+            if (level > 1) { // parent blocks holding these hashes are dirty now
+                const u32 log_parent = (&(info->log_ivfc_lvl1))[level - 2];
+                const u32 parent_end = min((hash_offset + (run_count * 0x20) - 1) >> log_parent, dirty->n_blocks[level - 2] - 1);
+                for (u32 p = hash_offset >> log_parent; p <= parent_end; p++)
+                    SET_DIRTY_BIT(p, dirty->bitmap[level - 2]);
+            }
+            run_count = 0;
         }
-
-        if (((level == 4) && info->ivfc_use_extlvl4) ? (DisaDiffRead(buf, read_size, align_offset + offset_ivfc_lvl) != FR_OK) :
-            (ReadDisaDiffDpfsLvl3(info, align_offset + offset_ivfc_lvl, read_size, buf) != read_size)) {
-            free(buf);
+        if (!is_dirty) continue;
+
+        // read and hash the dirty block
+        const u32 block_offset = b << log_ivfc_lvl;
+        const u32 read_size = min(block_size, size_ivfc_lvl - block_offset);
+        if (read_size < block_size) memset(buf, 0, block_size);
+        if (((level == 4) && info->ivfc_use_extlvl4) ? (DisaDiffRead(buf, read_size, block_offset + offset_ivfc_lvl) != FR_OK) :
+            (ReadDisaDiffDpfsLvl3(info, block_offset + offset_ivfc_lvl, read_size, buf) != read_size))
             return 1;
-        }
+        if (!run_count) run_start = b;
+        sha_quick(sha_buf + (run_count++ * 0x20), buf, block_size, SHA256_MODE);
+        CLEAR_DIRTY_BIT(b, bitmap);
+    }
 
-        sha_quick(sha_buf, buf, block_size, SHA256_MODE);
+    return 0;
+}
 
+u32 FixDisaDiffIvfcDirty(const DisaDiffRWInfo* info, DisaDiffIvfcDirty* dirty) {
+    if (!dirty->is_dirty) return 0;
 
-        if ((level == 1) ? (DisaDiffWrite(sha_buf, 0x20, info->offset_difi + info->offset_master_hash + ((align_offset >> log_ivfc_lvl) * 0x20)) != FR_OK) :
-            (WriteDisaDiffDpfsLvl3(info, (&(info->offset_ivfc_lvl1))[level - 2] + ((align_offset >> log_ivfc_lvl) * 0x20), 0x20, sha_buf) != 0x20)) {
-            free(buf);
+    // from lvl4 (data) up to lvl1, only touched blocks get rehashed
+    for (u32 level = 4; level > 0; level--) {
+        if (FixDisaDiffIvfcDirtyLevel(info, dirty, level) != 0)
             return 1;
-        }
-
-        align_offset += block_size;
-        align_size = ((align_size < block_size) ? 0 : (align_size - block_size));
     }
 
-    free(buf);
+    if (FixDisaDiffPartitionHash(info) != 0)
+        return 1;
 
+    dirty->is_dirty = false;
     return 0;
 }
 
-u32 ReadDisaDiffIvfcLvl4(const char* path, const DisaDiffRWInfo* info, u32 offset, u32 size, void* buffer) { // offset: offset inside IVFC lvl4
-    // DisaDiffRWInfo not provided?
-    DisaDiffRWInfo info_l;
-    u8* cache = NULL;
-    if (!info) {
-        info = &info_l;
-        if (GetDisaDiffRWInfo(path, (DisaDiffRWInfo*) info, false) != 0) return 0;
-        cache = malloc(info->size_dpfs_lvl2);
-        if (!cache) return 0;
-        if (BuildDisaDiffDpfsLvl2Cache(path, info, cache, info->size_dpfs_lvl2) != 0) {
-            free(cache);
-            return 0;
-        }
-    }
-
-    // open file pointer
-    if (DisaDiffOpen(path) != FR_OK)
-        size = 0;
-
+static u32 ReadDisaDiffIvfcLvl4Open(const DisaDiffRWInfo* info, u32 offset, u32 size, void* buffer) { // assumes file is already open
     // sanity checks - offset & size
     if (offset > info->size_ivfc_lvl4) return 0;
     else if (offset + size > info->size_ivfc_lvl4) size = info->size_ivfc_lvl4 - offset;
@@ -520,36 +562,14 @@ u32 ReadDisaDiffIvfcLvl4(const char* path, const DisaDiffRWInfo* info, u32 offse
         size = ReadDisaDiffDpfsLvl3(info, info->offset_ivfc_lvl4 + offset, size, buffer);
     }
 
-    DisaDiffClose();
-    if (cache) free(cache);
     return size;
 }
 
-u32 WriteDisaDiffIvfcLvl4(const char* path, const DisaDiffRWInfo* info, u32 offset, u32 size, const void* buffer) { // offset: offset inside IVFC lvl4. cmac still needs fixed after calling this.
-    // DisaDiffRWInfo not provided?
-    DisaDiffRWInfo info_l;
-    u8* cache = NULL;
-    if (!info) {
-        info = &info_l;
-        if (GetDisaDiffRWInfo(path, (DisaDiffRWInfo*) info, false) != 0)
-            return 0;
-        cache = malloc(info->size_dpfs_lvl2);
-        if (!cache)
-            return 0;
-        if (BuildDisaDiffDpfsLvl2Cache(path, info, cache, info->size_dpfs_lvl2) != 0) {
-            free(cache);
-            return 0;
-        }
-    }
-
+static u32 WriteDisaDiffIvfcLvl4Open(const DisaDiffRWInfo* info, u32 offset, u32 size, const void* buffer) { // assumes file is already open, does not fix hashes
     // sanity check - offset & size
     if (offset + size > info->size_ivfc_lvl4)
         return 0;
 
-    // open file pointer
-    if (DisaDiffOpen(path) != FR_OK)
-        size = 0;
-
     if (info->ivfc_use_extlvl4) {
         if (DisaDiffWrite(buffer, size, info->offset_ivfc_lvl4 + offset) != FR_OK)
             size = 0;
@@ -557,17 +577,134 @@ u32 WriteDisaDiffIvfcLvl4(const char* path, const DisaDiffRWInfo* info, u32 offs
         size = WriteDisaDiffDpfsLvl3(info, info->offset_ivfc_lvl4 + offset, size, buffer);
     }
 
-    if ((size != 0) && ddfp) { // if we're writing to a mounted image, the hash chain will be handled later by vdisadiff
-        u32 hashfix_offset = offset, hashfix_size = size;
-        for (int i = 4; i >= 0; i--) {
-            if (FixDisaDiffIvfcLevel(info, i, hashfix_offset, hashfix_size, &hashfix_offset, &hashfix_size) != 0) {
-                size = 0;
-                break;
-            }
+    return size;
+}
+
+u32 OpenDisaDiffSession(DisaDiffSession* session, const char* path, bool partitionB) { // path == NULL -> mounted image
+    DisaDiffRWInfo* info = &(session->info);
+    memset(session, 0x00, sizeof(DisaDiffSession));
+
+    // parse the container and build the lvl2 cache only once
+    if (GetDisaDiffRWInfo(path, info, partitionB) != 0) return 1;
+    u8* cache = (u8*) malloc(info->size_dpfs_lvl2);
+    if (!cache) return 1;
+    if (BuildDisaDiffDpfsLvl2Cache(path, info, cache, info->size_dpfs_lvl2) != 0) {
+        free(cache);
+        info->dpfs_lvl2_cache = NULL;
+        return 1;
+    }
+
+    // keep the file open until the session is closed
+    if (path) {
+        if (fvx_open(&(session->file), path, FA_READ | FA_WRITE | FA_OPEN_EXISTING) != FR_OK) {
+            free(cache);
+            info->dpfs_lvl2_cache = NULL;
+            return 1;
+        }
+        session->use_file = true;
+    } else if (!GetMountState()) {
+        free(cache);
+        info->dpfs_lvl2_cache = NULL;
+        return 1;
+    }
+
+    session->is_open = true;
+    return 0;
+}
+
+u32 ReadDisaDiffSession(DisaDiffSession* session, u32 offset, u32 size, void* buffer) { // offset: offset inside IVFC lvl4
+    if (!session->is_open) return 0;
+
+    ddfp = session->use_file ? &(session->file) : NULL;
+    size = ReadDisaDiffIvfcLvl4Open(&(session->info), offset, size, buffer);
+    ddfp = NULL;
+
+    return size;
+}
+
+u32 WriteDisaDiffSession(DisaDiffSession* session, u32 offset, u32 size, const void* buffer) { // offset: offset inside IVFC lvl4, hashes get fixed on close
+    if (!session->is_open) return 0;
+    if (!session->ivfc_dirty.scratch && (InitDisaDiffIvfcDirty(&(session->info), &(session->ivfc_dirty)) != 0))
+        return 0;
+
+    ddfp = session->use_file ? &(session->file) : NULL;
+    size = WriteDisaDiffIvfcLvl4Open(&(session->info), offset, size, buffer);
+    ddfp = NULL;
+
+    if (size) MarkDisaDiffIvfcDirty(&(session->info), &(session->ivfc_dirty), offset, size);
+    return size;
+}
+
+u32 CloseDisaDiffSession(DisaDiffSession* session) { // cmac still needs fixed after calling this
+    u32 ret = 0;
+    if (!session->is_open) return 1;
+
+    // fix the hash chain for everything written during the session
+    ddfp = session->use_file ? &(session->file) : NULL;
+    if (FixDisaDiffIvfcDirty(&(session->info), &(session->ivfc_dirty)) != 0) ret = 1;
+    ddfp = NULL;
+
+    if (session->use_file && (fvx_close(&(session->file)) != FR_OK)) ret = 1;
+    FreeDisaDiffIvfcDirty(&(session->ivfc_dirty));
+    if (session->info.dpfs_lvl2_cache) free(session->info.dpfs_lvl2_cache);
+    memset(session, 0x00, sizeof(DisaDiffSession));
+
+    return ret;
+}
+
+u32 ReadDisaDiffIvfcLvl4(const char* path, const DisaDiffRWInfo* info, u32 offset, u32 size, void* buffer) { // offset: offset inside IVFC lvl4
+    // DisaDiffRWInfo not provided? -> one shot session
+    if (!info) {
+        DisaDiffSession session;
+        if (OpenDisaDiffSession(&session, path, false) != 0) return 0;
+        size = ReadDisaDiffSession(&session, offset, size, buffer);
+        CloseDisaDiffSession(&session);
+        return size;
+    }
+
+    // open file pointer
+    if (DisaDiffOpen(path) != FR_OK)
+        return 0;
+
+    size = ReadDisaDiffIvfcLvl4Open(info, offset, size, buffer);
+
+    DisaDiffClose();
+    return size;
+}
+
+u32 WriteDisaDiffIvfcLvl4(const char* path, const DisaDiffRWInfo* info, u32 offset, u32 size, const void* buffer) { // offset: offset inside IVFC lvl4. cmac still needs fixed after calling this.
+    // DisaDiffRWInfo not provided? -> one shot session
+    if (!info) {
+        DisaDiffSession session;
+        if (OpenDisaDiffSession(&session, path, false) != 0) return 0;
+        size = WriteDisaDiffSession(&session, offset, size, buffer);
+        if (CloseDisaDiffSession(&session) != 0) size = 0;
+        return size;
+    }
+
+    // open file pointer
+    if (DisaDiffOpen(path) != FR_OK)
+        return 0;
+
+    // if we're writing to a mounted image, the hash chain will be handled later by vdisadiff
+    // otherwise, set up the dirty state before touching any data
+    DisaDiffIvfcDirty dirty;
+    bool fix_hashes = ddfp;
+    if (fix_hashes && (InitDisaDiffIvfcDirty(info, &dirty) != 0)) {
+        DisaDiffClose();
+        return 0;
+    }
+
+    size = WriteDisaDiffIvfcLvl4Open(info, offset, size, buffer);
+
+    if (fix_hashes) {
+        if (size != 0) {
+            MarkDisaDiffIvfcDirty(info, &dirty, offset, size);
+            if (FixDisaDiffIvfcDirty(info, &dirty) != 0) size = 0;
         }
+        FreeDisaDiffIvfcDirty(&dirty);
     }
 
     DisaDiffClose();
-    if (cache) free(cache);
     return size;
 }
\ No newline at end of file
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "common.h"
+#include "ff.h"
 
 
 // info taken from here:
@@ -46,9 +47,33 @@ typedef struct {
     u8* dpfs_lvl2_cache; // optional, NULL when unused
 } __attribute__((packed)) DisaDiffRWInfo;
 
+// dirty IVFC blocks, hashes get fixed in one go on commit
+typedef struct {
+    u8* bitmap[4]; // one bit per block for IVFC lvl1 ... lvl4
+    u32 n_blocks[4];
+    u8* scratch; // one block of the biggest IVFC level
+    bool is_dirty;
+} DisaDiffIvfcDirty;
+
+// open DISA/DIFF container, parsed info and lvl2 cache are kept until closed
+typedef struct {
+    DisaDiffRWInfo info;
+    DisaDiffIvfcDirty ivfc_dirty; // hashes get fixed on close
+    FIL file;
+    bool use_file; // false for the mounted image
+    bool is_open;
+} DisaDiffSession;
+
 u32 GetDisaDiffRWInfo(const char* path, DisaDiffRWInfo* info, bool partitionB);
 u32 BuildDisaDiffDpfsLvl2Cache(const char* path, const DisaDiffRWInfo* info, u8* cache, u32 cache_size);
 u32 ReadDisaDiffIvfcLvl4(const char* path, const DisaDiffRWInfo* info, u32 offset, u32 size, void* buffer);
 u32 WriteDisaDiffIvfcLvl4(const char* path, const DisaDiffRWInfo* info, u32 offset, u32 size, const void* buffer);
+u32 OpenDisaDiffSession(DisaDiffSession* session, const char* path, bool partitionB);
+u32 ReadDisaDiffSession(DisaDiffSession* session, u32 offset, u32 size, void* buffer);
+u32 WriteDisaDiffSession(DisaDiffSession* session, u32 offset, u32 size, const void* buffer);
+u32 CloseDisaDiffSession(DisaDiffSession* session);
 // Not intended for external use other than vdisadiff
-u32 FixDisaDiffIvfcLevel(const DisaDiffRWInfo* info, u32 level, u32 offset, u32 size, u32* next_offset, u32* next_size);
\ No newline at end of file
+u32 InitDisaDiffIvfcDirty(const DisaDiffRWInfo* info, DisaDiffIvfcDirty* dirty);
+void FreeDisaDiffIvfcDirty(DisaDiffIvfcDirty* dirty);
+void MarkDisaDiffIvfcDirty(const DisaDiffRWInfo* info, DisaDiffIvfcDirty* dirty, u32 offset, u32 size);
+u32 FixDisaDiffIvfcDirty(const DisaDiffRWInfo* info, DisaDiffIvfcDirty* dirty);
\ No newline at end of file
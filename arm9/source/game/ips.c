@@ -8,6 +8,9 @@
 #include "ui.h"
 #include "vff.h"
 
+#define IPS_BUFFER_SIZE     STD_BUFFER_SIZE // the one and only scratch buffer
+#define IPS_RECORDS_GROW    1024
+
 typedef enum {
     IPS_OK,
     IPS_NOTTHIS,
@@ -17,17 +20,46 @@ typedef enum {
     IPS_16MB,
     IPS_INVALID_FILE_PATH,
     IPS_CANCELED,
-    IPS_MEMORY
+    IPS_MEMORY,
+    IPS_IO
 } IPSERROR;
 
+typedef enum {
+    COPY_IN,
+    COPY_PATCH,
+    COPY_RLE
+} COPYMODE;
+
+// one patch record, as found in the patch file
+typedef struct {
+    u32 offset; // output offset
+    u32 src; // offset of the data (or RLE byte) inside the patch file
+    u16 size;
+    u8  mode; // COPY_PATCH or COPY_RLE
+    u8  rle;
+} IPSRecord;
+
 static FIL patchFile, inFile, outFile;
 static size_t patchSize;
-static u8 *patch;
 static u32 patchOffset;
 
+static u8* buffer = NULL;
+static IPSRecord* records = NULL;
+static u32 n_records = 0;
+
+// read-ahead window into the patch file (first pass)
+static u32 windowOffset;
+static u32 windowSize;
+static bool windowError; // patch file read failed, parsing sees zeroes
+
+// pending output (second pass)
+static u32 outOffset;
+static u32 outFill;
+
 char errName[256];
 
 int displayError(int errcode) {
+    if ((errcode == IPS_INVALID) && windowError) errcode = IPS_IO; // not the patch's fault
     switch(errcode) {
         case IPS_NOTTHIS:
             ShowPrompt(false, "%s\nThe patch is most likely not intended for this file.", errName); break;
@@ -45,81 +77,192 @@ int displayError(int errcode) {
             ShowPrompt(false, "%s\nPatching canceled.", errName); break;
         case IPS_MEMORY:
             ShowPrompt(false, "%s\nNot enough memory.", errName); break;
+        case IPS_IO:
+            ShowPrompt(false, "%s\nFailed reading or writing a file.", errName); break;
     }
+    if (buffer) free(buffer);
+    if (records) free(records);
+    buffer = NULL;
+    records = NULL;
     fvx_close(&patchFile);
     fvx_close(&inFile);
     fvx_close(&outFile);
     return errcode;
 }
 
-typedef enum {
-    COPY_IN,
-    COPY_PATCH,
-    COPY_RLE
-} COPYMODE;
-
-bool IPScopy(u8 mode, u32 size, u8 rle) {
-    bool ret = true;
-    if (mode == COPY_PATCH) {
-        UINT bytes_written = size;
-        if ((fvx_write(&outFile, &patch[patchOffset], size, &bytes_written) != FR_OK) ||
-            (size != bytes_written))
-            ret = false;
-        patchOffset += size;
-    } else {
-        u32 bufsiz = min(STD_BUFFER_SIZE, size);
-        u8* buffer = malloc(bufsiz);
-        if (!buffer) return false;
-        if (mode == COPY_RLE) memset(buffer, rle, bufsiz);
-
-        for (u64 pos = 0; (pos < size) && ret; pos += bufsiz) {
-            UINT read_bytes = min(bufsiz, size - pos);
-            UINT bytes_written = read_bytes;
-            if (((mode == COPY_IN) && (fvx_read(&inFile, buffer, read_bytes, &bytes_written) != FR_OK)) ||
-                ((mode == COPY_PATCH) && (fvx_read(&patchFile, buffer, read_bytes, &bytes_written) != FR_OK)) ||
-                (read_bytes != bytes_written))
-                ret = false;
-            if ((ret && (fvx_write(&outFile, buffer, read_bytes, &bytes_written) != FR_OK)) ||
-                (read_bytes != bytes_written))
-                ret = false;
-        }
-
-        free(buffer);
-    }
-    return ret;
+static bool IPSSeek(FIL* fp, u32 offset) {
+    return (fvx_tell(fp) == offset) || (fvx_lseek(fp, offset) == FR_OK);
 }
 
-u8 read8() {
+static u8 read8() {
     if (patchOffset >= patchSize) return 0;
-    return patch[patchOffset++];
+    if ((patchOffset < windowOffset) || (patchOffset >= windowOffset + windowSize)) {
+        UINT br;
+        windowOffset = patchOffset;
+        windowSize = 0;
+        if (!IPSSeek(&patchFile, windowOffset) ||
+            (fvx_read(&patchFile, buffer, min(IPS_BUFFER_SIZE, patchSize - windowOffset), &br) != FR_OK) || !br) {
+            windowError = true;
+            return 0;
+        }
+        windowSize = br;
+    }
+    return buffer[(patchOffset++) - windowOffset];
 }
 
-UINT read16() {
+static UINT read16() {
     if (patchOffset+1 >= patchSize) return 0;
-    UINT buf = patch[patchOffset++] << 8;
-    buf |= patch[patchOffset++];
+    UINT buf = read8() << 8;
+    buf |= read8();
     return buf;
 }
 
-UINT read24() {
+static UINT read24() {
     if (patchOffset+2 >= patchSize) return 0;
-    UINT buf = patch[patchOffset++] << 16;
-    buf |= patch[patchOffset++] << 8;
-    buf |= patch[patchOffset++];
+    UINT buf = read8() << 16;
+    buf |= read8() << 8;
+    buf |= read8();
     return buf;
 }
 
+static bool IPSAddRecord(u32 offset, u32 src, u16 size, u8 mode, u8 rle) {
+    if (!(n_records % IPS_RECORDS_GROW)) {
+        IPSRecord* new_records = realloc(records, (n_records + IPS_RECORDS_GROW) * sizeof(IPSRecord));
+        if (!new_records) return false;
+        records = new_records;
+    }
+    IPSRecord* record = &(records[n_records++]);
+    record->offset = offset;
+    record->src = src;
+    record->size = size;
+    record->mode = mode;
+    record->rle = rle;
+    return true;
+}
+
+static int IPSCompareOffset(const void* a, const void* b) {
+    const IPSRecord* ra = (const IPSRecord*) a;
+    const IPSRecord* rb = (const IPSRecord*) b;
+    if (ra->offset != rb->offset) return (ra->offset < rb->offset) ? -1 : 1;
+    return (ra->src < rb->src) ? -1 : (ra->src > rb->src) ? 1 : 0; // keep patch order
+}
+
+static int IPSComparePatchOrder(const void* a, const void* b) {
+    const IPSRecord* ra = (const IPSRecord*) a;
+    const IPSRecord* rb = (const IPSRecord*) b;
+    return (ra->src < rb->src) ? -1 : (ra->src > rb->src) ? 1 : 0;
+}
+
+static bool IPSSortRecords(void) {
+    // sort by output offset, only allowed if no records overlap (later records win)
+    qsort(records, n_records, sizeof(IPSRecord), IPSCompareOffset);
+    for (u32 i = 1; i < n_records; i++) {
+        if (records[i].offset < records[i-1].offset + records[i-1].size) {
+            qsort(records, n_records, sizeof(IPSRecord), IPSComparePatchOrder);
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool IPSFlush(void) {
+    UINT bytes_written;
+    if (!outFill) return true;
+    if (!IPSSeek(&outFile, outOffset) ||
+        (fvx_write(&outFile, buffer, outFill, &bytes_written) != FR_OK) ||
+        (bytes_written != outFill))
+        return false;
+    outOffset += outFill;
+    outFill = 0;
+    return true;
+}
+
+// queue up `size` bytes of output at `offset`, adjacent ranges get written in one go
+static bool IPScopy(u8 mode, u32 offset, u32 size, u32 src, u8 rle) {
+    if (offset != outOffset + outFill) {
+        if (!IPSFlush()) return false;
+        outOffset = offset;
+    }
+
+    while (size) {
+        u32 count = min(IPS_BUFFER_SIZE - outFill, size);
+        u8* dest = buffer + outFill;
+        if (mode == COPY_RLE) {
+            memset(dest, rle, count);
+        } else {
+            FIL* fp = (mode == COPY_IN) ? &inFile : &patchFile;
+            UINT read_bytes;
+            if (!IPSSeek(fp, src) ||
+                (fvx_read(fp, dest, count, &read_bytes) != FR_OK) ||
+                (read_bytes != count))
+                return false;
+            src += count;
+        }
+        outFill += count;
+        size -= count;
+        if ((outFill == IPS_BUFFER_SIZE) && !IPSFlush())
+            return false;
+    }
+
+    return true;
+}
+
+// output that is not covered by any record: input file, zero padded
+static bool IPScopyGap(u32 offset, u32 end, size_t inSize) {
+    if ((offset < inSize) && (offset < end)) {
+        u32 count = min(inSize, end) - offset;
+        if (!IPScopy(COPY_IN, offset, count, offset, 0)) return false;
+        offset += count;
+    }
+    return (offset >= end) || IPScopy(COPY_RLE, offset, end - offset, 0, 0);
+}
+
+static int IPSApplyRecords(const char* outName, size_t outSize, size_t inSize, bool sorted, bool inPlace) {
+    u32 pos = 0;
+    for (u32 i = 0; i < n_records; i++) {
+        IPSRecord* record = &(records[i]);
+        if (!ShowProgress(record->offset, outSize, outName)) {
+            if (ShowPrompt(true, "%s\nB button detected. Cancel?", outName)) return IPS_CANCELED;
+            ShowProgress(0, outSize, outName);
+            ShowProgress(record->offset, outSize, outName);
+        }
+
+        // anything beyond the end of the output is cut off anyways
+        if (record->offset >= outSize) continue;
+        u32 size = min(record->size, outSize - record->offset);
+
+        // fill the gap up to this record (only needed when writing a new, sorted file)
+        if (sorted && !inPlace && (pos < record->offset) && !IPScopyGap(pos, record->offset, inSize))
+            return IPS_IO;
+        if (!IPScopy(record->mode, record->offset, size, record->src, record->rle))
+            return IPS_IO;
+        pos = max(pos, record->offset + size);
+    }
+
+    if (sorted && !inPlace && (pos < outSize) && !IPScopyGap(pos, outSize, inSize))
+        return IPS_IO;
+
+    return IPS_OK;
+}
+
 int ApplyIPSPatch(const char* patchName, const char* inName, const char* outName) {
     int error = IPS_INVALID;
-    UINT outlen_min, outlen_max, outlen_min_mem;
+    UINT outlen_min, outlen_max;
     snprintf(errName, 256, "%s", patchName);
 
+    // reset state
+    patchOffset = 0;
+    windowOffset = windowSize = 0;
+    windowError = false;
+    outOffset = outFill = 0;
+    n_records = 0;
+
     if (fvx_open(&patchFile, patchName, FA_READ) != FR_OK) return displayError(IPS_INVALID_FILE_PATH);
     patchSize = fvx_size(&patchFile);
     ShowProgress(0, patchSize, patchName);
 
-    patch = malloc(patchSize);
-    if (!patch || fvx_read(&patchFile, patch, patchSize, NULL) != FR_OK) return displayError(IPS_MEMORY);
+    buffer = malloc(IPS_BUFFER_SIZE);
+    if (!buffer) return displayError(IPS_MEMORY);
 
     // Check validity of patch
     if (patchSize < 8) return displayError(IPS_INVALID);
@@ -151,11 +294,12 @@ int ApplyIPSPatch(const char* patchName, const char* inName, const char* outName
             size = read16();
             if (!size) return displayError(IPS_INVALID);
             thisout = offset + size;
-            read8();
+            if (!IPSAddRecord(offset, patchOffset, size, COPY_RLE, read8())) return displayError(IPS_MEMORY);
         }
         else
         {
             thisout = offset + size;
+            if (!IPSAddRecord(offset, patchOffset, size, COPY_PATCH, 0)) return displayError(IPS_MEMORY);
             patchOffset += size;
         }
         if (offset < lastoffset) w_scrambled = true;
@@ -164,7 +308,6 @@ int ApplyIPSPatch(const char* patchName, const char* inName, const char* outName
         if (patchOffset >= patchSize) return displayError(IPS_INVALID);
         offset = read24();
     }
-    outlen_min_mem = outlen;
     outlen_max = 0xFFFFFFFF;
     if (patchOffset+3 == patchSize)
     {
@@ -177,51 +320,41 @@ int ApplyIPSPatch(const char* patchName, const char* inName, const char* outName
         }
     }
     if (patchOffset != patchSize) return displayError(IPS_INVALID);
+    if (windowError) return displayError(IPS_IO);
     outlen_min = outlen;
     error = IPS_OK;
     if (w_scrambled) error = IPS_SCRAMBLED;
 
     // start applying patch
     bool inPlace = false;
+    size_t inSize;
     if (!CheckWritePermissions(outName)) return displayError(IPS_INVALID_FILE_PATH);
     if (strncasecmp(inName, outName, 256) == 0)
-    {
+    { // in place: only the patched ranges are touched
         if (fvx_open(&outFile, outName, FA_WRITE | FA_READ) != FR_OK) return displayError(IPS_INVALID_FILE_PATH);
-        inFile = outFile;
+        inSize = fvx_size(&outFile);
         inPlace = true;
     }
-    else if ((fvx_open(&inFile, inName, FA_READ) != FR_OK) ||
+    else
+    {
+        if ((fvx_open(&inFile, inName, FA_READ) != FR_OK) ||
             (fvx_open(&outFile, outName, FA_CREATE_ALWAYS | FA_WRITE | FA_READ) != FR_OK))
             return displayError(IPS_INVALID_FILE_PATH);
+        inSize = fvx_size(&inFile);
+    }
 
-    size_t inSize = fvx_size(&inFile);
     outlen = max(outlen_min, min(inSize, outlen_max));
-    fvx_lseek(&outFile, max(outlen, outlen_min_mem));
-    fvx_lseek(&outFile, 0);
     size_t outSize = outlen;
     ShowProgress(0, outSize, outName);
 
-    fvx_lseek(&inFile, 0);
-    if (!inPlace && !IPScopy(COPY_IN, min(inSize, outlen), 0)) return displayError(IPS_MEMORY);
-    fvx_lseek(&outFile, inSize);
-    if (outSize > inSize && !IPScopy(COPY_RLE, outSize - inSize, 0)) return displayError(IPS_MEMORY);
-
-    fvx_lseek(&patchFile, 5);
-    offset = read24();
-    while (offset != 0x454F46)
-    {
-        if (!ShowProgress(offset, outSize, outName)) {
-            if (ShowPrompt(true, "%s\nB button detected. Cancel?", outName)) return displayError(IPS_CANCELED);
-            ShowProgress(0, outSize, outName);
-            ShowProgress(offset, outSize, outName);
-        }
+    // sorted, non overlapping records allow writing the output in one sequential pass
+    bool sorted = IPSSortRecords();
+    if (!inPlace && !sorted && !IPScopyGap(0, outSize, inSize)) return displayError(IPS_IO);
+    if (inPlace && (outSize > inSize) && !IPScopy(COPY_RLE, inSize, outSize - inSize, 0, 0)) return displayError(IPS_IO);
 
-        fvx_lseek(&outFile, offset);
-        unsigned int size = read16();
-        if (size == 0 && !IPScopy(COPY_RLE, read16(), read8())) return displayError(IPS_MEMORY);
-        else if (size != 0 && !IPScopy(COPY_PATCH, size, 0)) return displayError(IPS_MEMORY);
-        offset = read24();
-    }
+    int res = IPSApplyRecords(outName, outSize, inSize, sorted, inPlace);
+    if (res != IPS_OK) return displayError(res);
+    if (!IPSFlush()) return displayError(IPS_IO);
 
     fvx_lseek(&outFile, outSize);
     f_truncate(&outFile);
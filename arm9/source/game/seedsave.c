@@ -77,27 +77,35 @@ u32 FindSeed(u8* seed, u64 titleId, u32 hash_seed) {
     const char* nand_drv[] = {"1:", "4:"}; // SysNAND and EmuNAND
     for (u32 i = 0; i < countof(nand_drv); i++) {
         char path[128];
-        SeedDb* seeddb = (SeedDb*) (void*) buffer;
+        DisaDiffSession session;
+        u64* titleIds = (u64*) (void*) buffer;
+        u32 n_entries;
 
-        // read SEEDDB from file
+        // only read the title ID list, the matching seed is read on demand
         if (GetSeedPath(path, nand_drv[i]) != 0) continue;
-        if ((ReadDisaDiffIvfcLvl4(path, NULL, SEEDSAVE_AREA_OFFSET, sizeof(SeedDb), seeddb) != sizeof(SeedDb)) ||
-        	(seeddb->n_entries > SEEDSAVE_MAX_ENTRIES))
+        if (OpenDisaDiffSession(&session, path, false) != 0) continue;
+        if ((ReadDisaDiffSession(&session, SEEDSAVE_AREA_OFFSET + offsetof(SeedDb, n_entries), 4, &n_entries) != 4) ||
+            (n_entries > SEEDSAVE_MAX_ENTRIES) ||
+            (ReadDisaDiffSession(&session, SEEDSAVE_AREA_OFFSET + offsetof(SeedDb, titleId), n_entries * 8, titleIds) != n_entries * 8)) {
+            CloseDisaDiffSession(&session);
             continue;
+        }
 
         // search for the seed
-        for (u32 s = 0; s < seeddb->n_entries; s++) {
-            if (titleId != seeddb->titleId[s]) continue;
-            memcpy(lseed, &(seeddb->seed[s]), sizeof(Seed));
+        for (u32 s = 0; s < n_entries; s++) {
+            if (titleId != titleIds[s]) continue;
+            if (ReadDisaDiffSession(&session, SEEDSAVE_AREA_OFFSET + offsetof(SeedDb, seed) + (s * sizeof(Seed)), sizeof(Seed), lseed) != sizeof(Seed))
+                break;
             sha_quick(sha256sum, lseed, 16 + 8, SHA256_MODE);
             if (hash_seed == sha256sum[0]) {
+                CloseDisaDiffSession(&session);
                 memcpy(seed, lseed, 16);
                 free(buffer);
                 return 0; // found!
             }
         }
+        CloseDisaDiffSession(&session);
     }
-	
 	// not found -> try seeddb.bin
     SeedInfo* seeddb = (SeedInfo*) (void*) buffer;
     size_t len = LoadSupportFile(SEEDINFO_NAME, seeddb, STD_BUFFER_SIZE);
@@ -138,13 +146,19 @@ u32 AddSeedToDb(SeedInfo* seed_info, SeedInfoEntry* seed_entry) {
 
 u32 InstallSeedDbToSystem(SeedInfo* seed_info, bool to_emunand) {
     char path[128];
+    DisaDiffSession session;
     SeedDb* seeddb = (SeedDb*) malloc(sizeof(SeedDb));
     if (!seeddb) return 1;
 
     // read the current SEEDDB database
     if ((GetSeedPath(path, to_emunand ? "4:" : "1:") != 0) ||
-        (ReadDisaDiffIvfcLvl4(path, NULL, SEEDSAVE_AREA_OFFSET, sizeof(SeedDb), seeddb) != sizeof(SeedDb)) ||
+        (OpenDisaDiffSession(&session, path, false) != 0)) {
+        free (seeddb);
+        return 1;
+    }
+    if ((ReadDisaDiffSession(&session, SEEDSAVE_AREA_OFFSET, sizeof(SeedDb), seeddb) != sizeof(SeedDb)) ||
         (seeddb->n_entries >= SEEDSAVE_MAX_ENTRIES)) {
+        CloseDisaDiffSession(&session);
         free (seeddb);
         return 1;
     }
@@ -161,7 +175,8 @@ u32 InstallSeedDbToSystem(SeedInfo* seed_info, bool to_emunand) {
     }
 
     // write back to system (warning: no write protection checks here)
-    u32 size = WriteDisaDiffIvfcLvl4(path, NULL, SEEDSAVE_AREA_OFFSET, sizeof(SeedDb), seeddb);
+    u32 size = WriteDisaDiffSession(&session, SEEDSAVE_AREA_OFFSET, sizeof(SeedDb), seeddb);
+    if (CloseDisaDiffSession(&session) != 0) size = 0;
     FixFileCmac(path, false);
 
     free (seeddb);
@@ -174,9 +189,15 @@ u32 SetupSeedPrePurchase(u64 titleId, bool to_emunand) {
 	if (!titletag) return 1;
 	
 	char path[128];
+	DisaDiffSession session;
 	if ((GetSeedPath(path, to_emunand ? "4:" : "1:") != 0) ||
-        (ReadDisaDiffIvfcLvl4(path, NULL, TITLETAG_AREA_OFFSET, sizeof(TitleTag), titletag) != sizeof(TitleTag)) ||
+        (OpenDisaDiffSession(&session, path, false) != 0)) {
+    	free (titletag);
+        return 1;
+    }
+	if ((ReadDisaDiffSession(&session, TITLETAG_AREA_OFFSET, sizeof(TitleTag), titletag) != sizeof(TitleTag)) ||
         (titletag->n_entries >= TITLETAG_MAX_ENTRIES)) {
+        CloseDisaDiffSession(&session);
     	free (titletag);
         return 1;
     }
@@ -199,7 +220,8 @@ u32 SetupSeedPrePurchase(u64 titleId, bool to_emunand) {
 	ttag->country_code = 1;
 
     // write back to system (warning: no write protection checks here)
-	u32 size = WriteDisaDiffIvfcLvl4(path, NULL, TITLETAG_AREA_OFFSET, sizeof(TitleTag), titletag);
+	u32 size = WriteDisaDiffSession(&session, TITLETAG_AREA_OFFSET, sizeof(TitleTag), titletag);
+	if (CloseDisaDiffSession(&session) != 0) size = 0;
 	FixFileCmac(path, false);
 	
 	free(titletag);
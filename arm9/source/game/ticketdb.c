@@ -6,6 +6,25 @@
 #include "image.h"
 
 #define PART_PATH "D:/partitionA.bin"
+#define TIKDB_INDEX_MAX_SIZE (4 * 1024 * 1024) // bigger ticket.dbs use the regular lookup
+
+// in-memory ticket.db index, only used inside a ticket DB session
+typedef struct {
+    u8 title_id[8]; // must be first (see compTitleId)
+    u32 seq; // position in ticket.db, for duplicate title ids
+    Ticket* ticket;
+} TicketDBEntry;
+
+typedef struct {
+    bool loaded;
+    u32 n_entries;
+    u32 max_entries;
+    u32 size; // total size of all indexed tickets
+    TicketDBEntry* entries; // sorted by title id, unique
+} TicketDBIndex;
+
+static bool tikdb_session = false;
+static TicketDBIndex tikdb_index[2] = { 0 }; // SysNAND / EmuNAND
 
 u32 CryptTitleKey(TitleKeyEntry* tik, bool encrypt, bool devkit) {
     // From https://github.com/profi200/Project_CTR/blob/master/makerom/pki/prod.h#L19
@@ -54,6 +73,122 @@ u32 GetTitleKey(u8* titlekey, Ticket* ticket) {
     return 0;
 }
 
+static int compTitleId(const void* a, const void* b) {
+    return memcmp(a, b, 8);
+}
+
+static int compTicketDBEntry(const void* a, const void* b) {
+    const TicketDBEntry* ea = (const TicketDBEntry*) a;
+    const TicketDBEntry* eb = (const TicketDBEntry*) b;
+    int cmp = memcmp(ea->title_id, eb->title_id, 8);
+    if (cmp) return cmp;
+    return (ea->seq > eb->seq) ? 1 : (ea->seq < eb->seq) ? -1 : 0;
+}
+
+static void FreeTicketDBIndex(TicketDBIndex* index) {
+    if (index->entries) {
+        for (u32 i = 0; i < index->n_entries; i++)
+            free(index->entries[i].ticket);
+    }
+    free(index->entries);
+    memset(index, 0, sizeof(TicketDBIndex));
+}
+
+static bool AddTicketToIndex(const u8* title_id, Ticket* ticket, void* data) {
+    TicketDBIndex* index = (TicketDBIndex*) data;
+    u32 size = GetTicketSize(ticket);
+    if (index->size + size > TIKDB_INDEX_MAX_SIZE) {
+        free(ticket);
+        return false;
+    }
+    if (index->n_entries >= index->max_entries) {
+        u32 max_entries = index->max_entries ? index->max_entries * 2 : 256;
+        TicketDBEntry* entries = (TicketDBEntry*) realloc(index->entries, max_entries * sizeof(TicketDBEntry));
+        if (!entries) {
+            free(ticket);
+            return false;
+        }
+        index->entries = entries;
+        index->max_entries = max_entries;
+    }
+    TicketDBEntry* entry = index->entries + index->n_entries;
+    memcpy(entry->title_id, title_id, 8);
+    entry->seq = index->n_entries++;
+    entry->ticket = ticket;
+    index->size += size;
+    return true;
+}
+
+static u32 LoadTicketDBIndex(TicketDBIndex* index, bool emunand) {
+    const char* path_db = TICKDB_PATH(emunand); // EmuNAND / SysNAND
+    char path_store[256] = { 0 };
+    char* path_bak = NULL;
+    u32 ret = 0;
+
+    FreeTicketDBIndex(index);
+    index->loaded = true; // even if this fails, don't try again
+
+    // store previous mount path
+    strncpy(path_store, GetMountPath(), 256);
+    if (*path_store) path_bak = path_store;
+    if (!InitImgFS(path_db)) {
+        InitImgFS(path_bak);
+        return 1;
+    }
+
+    // read all tickets in one pass, sort them by title id for binary search
+    if (EnumerateTicketsInDB(PART_PATH, AddTicketToIndex, index) != 0) ret = 1;
+    else if (index->n_entries) {
+        qsort(index->entries, index->n_entries, sizeof(TicketDBEntry), compTicketDBEntry);
+        // duplicate title ids: keep only the first ticket in ticket.db order
+        u32 n_unique = 1;
+        for (u32 i = 1; i < index->n_entries; i++) {
+            TicketDBEntry* entry = index->entries + i;
+            if (memcmp(entry->title_id, index->entries[n_unique-1].title_id, 8) == 0) {
+                index->size -= GetTicketSize(entry->ticket);
+                free(entry->ticket);
+            } else index->entries[n_unique++] = *entry;
+        }
+        index->n_entries = n_unique;
+    }
+
+    InitImgFS(path_bak);
+    if (ret != 0) {
+        FreeTicketDBIndex(index);
+        index->loaded = true;
+    }
+    return ret;
+}
+
+static u32 FindTicketInIndex(Ticket** ticket, u8* title_id, bool force_legit, TicketDBIndex* index) {
+    TicketDBEntry* entry = (TicketDBEntry*) bsearch(title_id, index->entries, index->n_entries, sizeof(TicketDBEntry), compTitleId);
+    Ticket* tik = entry ? entry->ticket : NULL;
+    if (!tik) return 1;
+
+    // (optional) validate ticket signature
+    if (force_legit && (ValidateTicketSignature(tik) != 0))
+        return 1;
+
+    // caller owns the returned ticket
+    u32 size = GetTicketSize(tik);
+    *ticket = (Ticket*) malloc(size);
+    if (!*ticket) return 1;
+    memcpy(*ticket, tik, size);
+
+    return 0;
+}
+
+void OpenTicketDB(void) {
+    CloseTicketDB();
+    tikdb_session = true;
+}
+
+void CloseTicketDB(void) {
+    for (u32 i = 0; i < 2; i++)
+        FreeTicketDBIndex(tikdb_index + i);
+    tikdb_session = false;
+}
+
 u32 FindTicket(Ticket** ticket, u8* title_id, bool force_legit, bool emunand) {
     const char* path_db = TICKDB_PATH(emunand); // EmuNAND / SysNAND
     char path_store[256] = { 0 };
@@ -62,6 +197,13 @@ u32 FindTicket(Ticket** ticket, u8* title_id, bool force_legit, bool emunand) {
     // just to be safe
     *ticket = NULL;
 
+    // inside a session, ticket.db is only mounted once for all lookups
+    if (tikdb_session) {
+        TicketDBIndex* index = tikdb_index + (emunand ? 1 : 0);
+        if (!index->loaded) LoadTicketDBIndex(index, emunand);
+        if (index->entries) return FindTicketInIndex(ticket, title_id, force_legit, index);
+    }
+
     // store previous mount path
     strncpy(path_store, GetMountPath(), 256);
     if (*path_store) path_bak = path_store;
@@ -35,6 +35,8 @@ typedef struct {
 
 
 u32 GetTitleKey(u8* titlekey, Ticket* ticket);
+void OpenTicketDB(void);
+void CloseTicketDB(void);
 u32 FindTicket(Ticket** ticket, u8* title_id, bool force_legit, bool emunand);
 u32 FindTitleKey(Ticket* ticket, u8* title_id);
 u32 AddTitleKeyToInfo(TitleKeysInfo* tik_info, TitleKeyEntry* tik_entry, bool decrypted_in, bool decrypted_out, bool devkit);
@@ -30,6 +30,9 @@
 #define REG_AESKEYXFIFO (*(vu32*)0x10009104)
 #define REG_AESKEYYFIFO (*(vu32*)0x10009108)
 
+// from aes.h (which clashes with the defines above)
+void invalidate_aeskey(u32 keyslot);
+
 u32 CartID = 0xFFFFFFFFu;
 u32 CartType = 0;
 
@@ -107,6 +110,7 @@ void Cart_Init(void)
 
 static void AES_SetKeyControl(u32 a) {
     REG_AESKEYCNT = (REG_AESKEYCNT & 0xC0) | a | 0x80;
+    invalidate_aeskey(a);
 }
 
 //returns 1 if MAC valid otherwise 0
@@ -174,25 +174,25 @@ void GetTimeString(char* timestr, bool forced_update, bool full_year) {
 }
 
 void CheckBattery(u32* battery, bool* is_charging) {
-    if (battery) {
-        static u32 battery_l = 0;
-        static u64 timer_b = (u64) -1; // this ensures we don't check too often
-        if ((timer_b == (u64) -1) || (timer_sec(timer_b) >= 120)) {
-            battery_l = GetBatteryPercent();
-            timer_b = timer_start();
-        }
-        *battery = battery_l;
-    }
-
-    if (is_charging) {
-        static bool is_charging_l = false;
-        static u64 timer_c = (u64) -1;
-        if ((timer_c == (u64) -1) || (timer_sec(timer_c) >= 1)) {
-            is_charging_l = IsCharging();
-            timer_c = timer_start();
-        }
-        *is_charging = is_charging_l;
-    }
+    static u32 battery_l = 0;
+    static bool is_charging_l = false;
+    static u64 timer_b = (u64) -1; // this ensures we don't check too often
+    static u64 timer_c = (u64) -1;
+    bool update_b = battery && ((timer_b == (u64) -1) || (timer_sec(timer_b) >= 120));
+    bool update_c = is_charging && ((timer_c == (u64) -1) || (timer_sec(timer_c) >= 1));
+
+    if (update_b && update_c) { // one batched MCU request for both
+        GetPowerStatus(&battery_l, &is_charging_l);
+    } else if (update_b) {
+        battery_l = GetBatteryPercent();
+    } else if (update_c) {
+        is_charging_l = IsCharging();
+    }
+    if (update_b) timer_b = timer_start();
+    if (update_c) timer_c = timer_start();
+
+    if (battery) *battery = battery_l;
+    if (is_charging) *is_charging = is_charging_l;
 }
 
 void DrawBatteryBitmap(u16* screen, u32 b_x, u32 b_y, u32 width, u32 height) {
@@ -254,11 +254,14 @@ void DrawTopBar(const char* curr_path) {
         show_time = false;
     }
     #elif defined MONITOR_HEAP
-    if (true) { // allocated mem
-        const u32 bartxt_rx = SCREEN_WIDTH_TOP - (9*FONT_WIDTH_EXT) - bartxt_x;
+    if (true) { // filetype cache hits/misses & allocated mem
+        const u32 bartxt_rx = SCREEN_WIDTH_TOP - (19*FONT_WIDTH_EXT) - bartxt_x;
         char bytestr[32];
+        u32 ft_hits, ft_misses;
+        GetFileTypeCacheStats(&ft_hits, &ft_misses);
         FormatBytes(bytestr, mem_allocated());
-        DrawStringF(TOP_SCREEN, bartxt_rx, bartxt_start, COLOR_STD_BG, COLOR_TOP_BAR, "%9.9s", bytestr);
+        snprintf(tempstr, 64, "%lu/%lu %s", ft_hits, ft_misses, bytestr);
+        DrawStringF(TOP_SCREEN, bartxt_rx, bartxt_start, COLOR_STD_BG, COLOR_TOP_BAR, "%19.19s", tempstr);
         show_time = false;
     }
     #endif
@@ -1069,8 +1072,13 @@ u32 DirFileAttrMenu(const char* path, const char *name) {
 }
 
 u32 FileHandlerMenu(char* current_path, u32* cursor, u32* scroll, PaneData** pane) {
-    const char* file_path = (&(current_dir->entry[*cursor]))->path;
-    const char* file_name = (&(current_dir->entry[*cursor]))->name;
+    // work on a copy, refreshing the dir contents reuses the entries and their strings
+    DirEntry* curr_entry = &(current_dir->entry[*cursor]);
+    char file_path[256];
+    u32 path_len = min(curr_entry->p_name + strnlen(curr_entry->name, 256) + 1, 256);
+    memcpy(file_path, curr_entry->path, path_len);
+    file_path[path_len-1] = '\0';
+    const char* file_name = file_path + curr_entry->p_name;
     const char* optionstr[16];
 
     // check for file lock
@@ -1528,6 +1536,7 @@ u32 FileHandlerMenu(char* current_path, u32* cursor, u32* scroll, PaneData** pan
         if ((n_marked > 1) && ShowPrompt(true, "Try to process all %lu selected files?", n_marked)) {
             u32 n_success = 0;
             u32 n_other = 0;
+            if (user_select != cxi_dump) OpenTicketDB(); // ticket.db is mounted once for all files
             for (u32 i = 0; i < current_dir->n_entries; i++) {
                 const char* path = current_dir->entry[i].path;
                 if (!current_dir->entry[i].marked)
@@ -1547,6 +1556,7 @@ u32 FileHandlerMenu(char* current_path, u32* cursor, u32* scroll, PaneData** pan
                 }
                 current_dir->entry[i].marked = false;
             }
+            CloseTicketDB();
             if (n_other) ShowPrompt(false, "%lu/%lu %ss built ok\n%lu/%lu not of same type",
                 n_success, n_marked, type, n_other, n_marked);
             else ShowPrompt(false, "%lu/%lu %ss built ok", n_success, n_marked, type);
@@ -1822,12 +1832,12 @@ u32 FileHandlerMenu(char* current_path, u32* cursor, u32* scroll, PaneData** pan
                 DirEntry* entry = &(current_dir->entry[i]);
                 if (!current_dir->entry[i].marked) continue;
                 ShowProgress(i+1, current_dir->n_entries, entry->name);
-                if (!GoodRenamer(entry, false)) continue;
+                if (!GoodRenamer(current_dir, entry, false)) continue;
                 n_success++;
                 current_dir->entry[i].marked = false;
             }
             ShowPrompt(false, "%lu/%lu renamed ok", n_success, n_marked);
-        } else if (!GoodRenamer(&(current_dir->entry[*cursor]), true)) {
+        } else if (!GoodRenamer(current_dir, &(current_dir->entry[*cursor]), true)) {
             ShowPrompt(false, "%s\nCould not rename to good name", pathstr);
         }
         return 0;
@@ -2348,6 +2358,8 @@ u32 GodMode(int entrypoint) {
             ShowPrompt(false, "Out of memory."); // just to be safe
             return exit_mode;
         }
+        InitDirStruct(current_dir);
+        InitDirStruct(clipboard);
 
         GetDirContents(current_dir, "");
         clipboard->n_entries = 0;
@@ -2548,6 +2560,9 @@ u32 GodMode(int entrypoint) {
             clipboard->n_entries = (clipboard->n_entries > 0) ? 0 : last_clipboard_size;
         }
 
+        // dir contents may have been reloaded (entries are reallocated on growth)
+        curr_entry = &(current_dir->entry[(cursor < current_dir->n_entries) ? cursor : 0]);
+
         // highly specific commands
         if (!*current_path) { // in the root folder...
             if (switched && (pad_state & BUTTON_X)) { // unmount image
@@ -2596,13 +2611,11 @@ u32 GodMode(int entrypoint) {
                 for (u32 c = 0; c < current_dir->n_entries; c++) {
                     if (current_dir->entry[c].marked) {
                         current_dir->entry[c].marked = 0;
-                        DirEntryCpy(&(clipboard->entry[clipboard->n_entries]), &(current_dir->entry[c]));
-                        clipboard->n_entries++;
+                        if (!DirEntryCpy(clipboard, &(current_dir->entry[c]))) break;
                     }
                 }
                 if ((clipboard->n_entries == 0) && (curr_entry->type != T_DOTDOT)) {
-                    DirEntryCpy(&(clipboard->entry[0]), curr_entry);
-                    clipboard->n_entries = 1;
+                    DirEntryCpy(clipboard, curr_entry);
                 }
                 if (clipboard->n_entries)
                     last_clipboard_size = clipboard->n_entries;
@@ -2801,6 +2814,8 @@ u32 GodMode(int entrypoint) {
     DeinitExtFS();
     DeinitSDCardFS();
 
+    if (current_dir) FreeDirStruct(current_dir);
+    if (clipboard) FreeDirStruct(clipboard);
     if (current_dir) free(current_dir);
     if (clipboard) free(clipboard);
     if (panedata) free(panedata);
@@ -12,6 +12,20 @@
 #define KEY95_SHA256    ((IS_DEVKIT) ? slot0x11Key95dev_sha256 : slot0x11Key95_sha256)
 #define SECTOR_SHA256   ((IS_DEVKIT) ? sector0x96dev_sha256 : sector0x96_sha256)
 
+// number of decrypted sectors held in the sector cache
+#ifndef NAND_CACHE_SECTORS
+#define NAND_CACHE_SECTORS 32
+#endif
+
+typedef struct {
+    u32 nand_src; // 0 if the entry is unused
+    u32 keyslot;
+    u32 sector;
+    u32 base; // EmuNAND base sector at the time the entry was filled
+    u32 last_use;
+    u8  ALIGN(4) data[0x200];
+} NandCacheEntry;
+
 // see: https://www.3dbrew.org/wiki/NCSD#NCSD_header
 static const u32 np_keyslots[10][4] = { // [NP_TYPE][NP_SUBTYPE]
     { 0xFF, 0xFF, 0xFF, 0xFF }, // none
@@ -61,6 +75,11 @@ static bool Crypto0x96 = false;
 
 static u32 emunand_base_sector = 0x000000;
 
+static NandCacheEntry nand_cache[NAND_CACHE_SECTORS];
+static u32 nand_cache_clock = 0;
+static u32 nand_cache_hits = 0;
+static u32 nand_cache_misses = 0;
+
 
 bool GetOtp0x90(void* otp0x90, u32 len)
 {
@@ -145,6 +164,7 @@ bool InitNandCrypto(bool init_full)
                 vu32 *RegKey0x01X = &REG_AESKEY0123[((0x30u * 0x01) + 0x10u)/4u];
                 RegKey0x01X[2] = (u32) (TwlCustId>>32);
                 RegKey0x01X[3] = (u32) (TwlCustId>>0);
+                invalidate_aeskey(0x01);
 
                 setup_aeskeyX(0x02, (u8*)0x01FFD398);
                 if (IS_DEVKIT) {
@@ -171,6 +191,9 @@ bool InitNandCrypto(bool init_full)
     // part #5: FULL INIT
     if (init_full) InitKeyDb(NULL);
 
+    // keys may have changed, cached sectors are no longer trustworthy
+    InvalidateNandCache(NAND_SYSNAND|NAND_EMUNAND|NAND_IMGNAND);
+
     return true;
 }
 
@@ -315,7 +338,7 @@ int WriteNandBytes(const void* buffer, u64 offset, u64 count, u32 keyslot, u32 n
     }
 }
 
-int ReadNandSectors(void* buffer, u32 sector, u32 count, u32 keyslot, u32 nand_src)
+static int ReadNandSectorsUncached(void* buffer, u32 sector, u32 count, u32 keyslot, u32 nand_src)
 {
     u8* buffer8 = (u8*) buffer;
     if (!count) return 0; // <--- just to be safe
@@ -347,8 +370,76 @@ int ReadNandSectors(void* buffer, u32 sector, u32 count, u32 keyslot, u32 nand_s
     return 0;
 }
 
+static NandCacheEntry* FindNandCacheEntry(u32 sector, u32 keyslot, u32 nand_src)
+{
+    u32 base = (nand_src == NAND_EMUNAND) ? emunand_base_sector : 0;
+    for (u32 i = 0; i < NAND_CACHE_SECTORS; i++) {
+        NandCacheEntry* entry = nand_cache + i;
+        if ((entry->nand_src == nand_src) && (entry->sector == sector) &&
+            (entry->keyslot == keyslot) && (entry->base == base))
+            return entry;
+    }
+    return NULL;
+}
+
+static NandCacheEntry* GetNandCacheVictim(void)
+{
+    NandCacheEntry* victim = nand_cache;
+    for (u32 i = 0; (i < NAND_CACHE_SECTORS) && victim->nand_src; i++) {
+        NandCacheEntry* entry = nand_cache + i;
+        if (!entry->nand_src || (entry->last_use < victim->last_use))
+            victim = entry; // free entry or least recently used one
+    }
+    return victim;
+}
+
+void InvalidateNandCache(u32 nand_src)
+{
+    for (u32 i = 0; i < NAND_CACHE_SECTORS; i++)
+        if (nand_cache[i].nand_src & nand_src) nand_cache[i].nand_src = 0;
+}
+
+void GetNandCacheStats(u32* hits, u32* misses)
+{
+    if (hits) *hits = nand_cache_hits;
+    if (misses) *misses = nand_cache_misses;
+}
+
+int ReadNandSectors(void* buffer, u32 sector, u32 count, u32 keyslot, u32 nand_src)
+{
+    // single sector reads (that's FAT and directory sectors) go through the cache
+    if ((count == 1) && (nand_src & (NAND_SYSNAND|NAND_EMUNAND|NAND_IMGNAND))) {
+        NandCacheEntry* entry = FindNandCacheEntry(sector, keyslot, nand_src);
+        if (entry) {
+            nand_cache_hits++;
+        } else {
+            nand_cache_misses++;
+            entry = GetNandCacheVictim();
+            entry->nand_src = 0; // in case the read fails
+            int errorcode = ReadNandSectorsUncached(entry->data, sector, 1, keyslot, nand_src);
+            if (errorcode) return errorcode;
+            entry->nand_src = nand_src;
+            entry->keyslot = keyslot;
+            entry->sector = sector;
+            entry->base = (nand_src == NAND_EMUNAND) ? emunand_base_sector : 0;
+        }
+        entry->last_use = ++nand_cache_clock;
+        memcpy(buffer, entry->data, 0x200);
+        return 0;
+    }
+
+    return ReadNandSectorsUncached(buffer, sector, count, keyslot, nand_src);
+}
+
 int WriteNandSectors(const void* buffer, u32 sector, u32 count, u32 keyslot, u32 nand_dst)
 {
+    // write-through: drop everything cached for the written sectors
+    for (u32 i = 0; i < NAND_CACHE_SECTORS; i++) {
+        NandCacheEntry* entry = nand_cache + i;
+        if ((entry->nand_src == nand_dst) && (entry->sector >= sector) && (entry->sector - sector < count))
+            entry->nand_src = 0;
+    }
+
     // buffer must not be changed, so this is a little complicated
     void* nand_buffer = (void*) malloc(min(STD_BUFFER_SIZE, count * 0x200));
     if (!nand_buffer) return -1;
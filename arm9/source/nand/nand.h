@@ -81,6 +81,8 @@ int ReadNandBytes(void* buffer, u64 offset, u64 count, u32 keyslot, u32 nand_src
 int WriteNandBytes(const void* buffer, u64 offset, u64 count, u32 keyslot, u32 nand_dst);
 int ReadNandSectors(void* buffer, u32 sector, u32 count, u32 keyslot, u32 nand_src);
 int WriteNandSectors(const void* buffer, u32 sector, u32 count, u32 keyslot, u32 nand_dest);
+void InvalidateNandCache(u32 nand_src);
+void GetNandCacheStats(u32* hits, u32* misses);
 
 u32 ValidateNandNcsdHeader(NandNcsdHeader* header);
 u32 GetNandNcsdMinSizeSectors(NandNcsdHeader* ncsd);
@@ -4,6 +4,7 @@
 #include "i2c.h"
 #include "pxi.h"
 #include "shmem.h"
+#include "jobs.h"
 
 bool I2C_readRegBuf(I2cDevice devId, u8 regAddr, u8 *out, u32 size)
 {
@@ -48,3 +49,13 @@ bool I2C_writeReg(I2cDevice devId, u8 regAddr, u8 data)
 {
 	return I2C_writeRegBuf(devId, regAddr, &data, 1);
 }
+
+u32 I2C_queueReadRegBuf(I2cDevice devId, u8 regAddr, u32 size)
+{
+	return JOB_Queue(JOB_I2C_READ, 0, devId, regAddr, size, NULL, 0);
+}
+
+bool I2C_waitReadRegBuf(u32 ticket, u8 *out, u32 size)
+{
+	return ticket && JOB_WaitData(ticket, out, size);
+}
@@ -79,3 +79,26 @@ u8 I2C_readReg(I2cDevice devId, u8 regAddr);
  * @return     Returns true on success and false on failure.
  */
 bool I2C_writeReg(I2cDevice devId, u8 regAddr, u8 data);
+
+/**
+ * @brief      Queues a small I2C register read on the ARM11 job queue.
+ *             Several reads can be queued before waiting on any of them.
+ *
+ * @param[in]  devId    The device ID. Use the enum above.
+ * @param[in]  regAddr  The register address.
+ * @param[in]  size     The read size, at most JOB_DATA_SIZE.
+ *
+ * @return     Returns the request ticket, 0 if the read couldn't be queued.
+ */
+u32 I2C_queueReadRegBuf(I2cDevice devId, u8 regAddr, u32 size);
+
+/**
+ * @brief      Waits for a queued I2C register read to finish.
+ *
+ * @param[in]  ticket   The ticket returned by I2C_queueReadRegBuf.
+ * @param      out      The output buffer pointer.
+ * @param[in]  size     The read size.
+ *
+ * @return     Returns true on success and false on failure.
+ */
+bool I2C_waitReadRegBuf(u32 ticket, u8 *out, u32 size);
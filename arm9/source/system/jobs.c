@@ -0,0 +1,111 @@
+#include "common.h"
+#include "arm.h"
+#include "pxi.h"
+#include "shmem.h"
+#include "jobs.h"
+
+static u32 JOB_GetTail(SystemJobQueue *queue)
+{
+	// only the ARM11 writes this, never trust the cached copy
+	ARM_InvDC_Range((void*)&queue->tail, sizeof(u32));
+	return queue->tail;
+}
+
+bool JOB_Available(void)
+{
+	return ARM_GetSHMEM() != NULL;
+}
+
+static u32 kickedHead;
+
+void JOB_Kick(void)
+{
+	SystemJobQueue *queue;
+
+	if (!JOB_Available())
+		return;
+
+	// only ring the doorbell if there's something new
+	queue = &ARM_GetSHMEM()->jobQueue;
+	if (queue->head == kickedHead)
+		return;
+
+	kickedHead = queue->head;
+	PXI_DoCMD(PXI_JOB_NOTIFY, NULL, 0);
+}
+
+u32 JOB_Queue(u32 type, u32 flags, u32 arg0, u32 arg1, u32 arg2, const void *data, u32 size)
+{
+	SystemJobQueue *queue;
+	SystemJob *job;
+	u32 head;
+
+	if (!JOB_Available() || (size > JOB_DATA_SIZE))
+		return 0;
+
+	queue = &ARM_GetSHMEM()->jobQueue;
+	head = queue->head;
+
+	// wait for a free slot, the ARM11 might not know about the queued jobs yet
+	if ((head - JOB_GetTail(queue)) >= JOB_QUEUE_SLOTS) {
+		JOB_Kick();
+		while((head - JOB_GetTail(queue)) >= JOB_QUEUE_SLOTS);
+	}
+
+	job = &queue->slot[head % JOB_QUEUE_SLOTS];
+	job->type = type;
+	job->flags = flags;
+	job->args[0] = arg0;
+	job->args[1] = arg1;
+	job->args[2] = arg2;
+	job->result = 0;
+	if (data)
+		memcpy(job->data, data, size);
+	ARM_WbInvDC_Range(job, sizeof(SystemJob));
+	ARM_DSB();
+
+	// publish the job, the ARM11 picks it up on the next kick
+	queue->head = ++head;
+	ARM_WbDC_Range((void*)&queue->head, sizeof(u32));
+	ARM_DSB();
+
+	return head;
+}
+
+u32 JOB_Submit(u32 type, u32 flags, u32 arg0, u32 arg1, u32 arg2)
+{
+	u32 ticket = JOB_Queue(type, flags, arg0, arg1, arg2, NULL, 0);
+	JOB_Kick();
+	return ticket;
+}
+
+bool JOB_Done(u32 ticket)
+{
+	if (!JOB_Available())
+		return true;
+	return (s32)(JOB_GetTail(&ARM_GetSHMEM()->jobQueue) - ticket) >= 0;
+}
+
+u32 JOB_Wait(u32 ticket)
+{
+	SystemJob *job;
+
+	if (!ticket || !JOB_Available())
+		return 0;
+
+	JOB_Kick();
+	while(!JOB_Done(ticket));
+
+	job = &ARM_GetSHMEM()->jobQueue.slot[(ticket - 1) % JOB_QUEUE_SLOTS];
+	ARM_InvDC_Range(job, sizeof(SystemJob));
+	return job->result;
+}
+
+u32 JOB_WaitData(u32 ticket, void *data, u32 size)
+{
+	u32 res = JOB_Wait(ticket);
+
+	if (ticket && JOB_Available() && (size <= JOB_DATA_SIZE))
+		memcpy(data, ARM_GetSHMEM()->jobQueue.slot[(ticket - 1) % JOB_QUEUE_SLOTS].data, size);
+	return res;
+}
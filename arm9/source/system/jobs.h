@@ -0,0 +1,15 @@
+#pragma once
+
+#include "common.h"
+#include "shmem.h"
+
+// ARM11 job offloading, tickets are never 0
+// results stay available until JOB_QUEUE_SLOTS more jobs got submitted
+// queued jobs are batched until the next kick (waiting on a ticket kicks, too)
+bool JOB_Available(void);
+u32 JOB_Queue(u32 type, u32 flags, u32 arg0, u32 arg1, u32 arg2, const void *data, u32 size);
+void JOB_Kick(void);
+u32 JOB_Submit(u32 type, u32 flags, u32 arg0, u32 arg1, u32 arg2);
+bool JOB_Done(u32 ticket);
+u32 JOB_Wait(u32 ticket);
+u32 JOB_WaitData(u32 ticket, void *data, u32 size);
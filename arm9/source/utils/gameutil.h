@@ -17,6 +17,7 @@ u32 ShowGameFileTitleInfo(const char* path);
 u32 ShowCiaCheckerInfo(const char* path);
 u32 UninstallGameDataTie(const char* path, bool remove_tie, bool remove_ticket, bool remove_save);
 u32 GetTmdContentPath(char* path_content, const char* path_tmd);
+u32 GetTieTmdPath(char* path_tmd, const char* path_tie);
 u32 GetTieContentPath(char* path_content, const char* path_tie);
 u32 BuildNcchInfoXorpads(const char* destdir, const char* path);
 u32 CheckHealthAndSafetyInject(const char* hsdrv);
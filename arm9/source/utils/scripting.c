@@ -23,7 +23,7 @@
 #define _ARG_MAX_LEN    512
 #define _VAR_CNT_LEN    256
 #define _VAR_NAME_LEN   32
-#define _VAR_MAX_BUFF   256
+#define _VAR_HASH_SIZE  64 // # of buckets in the variable table, power of 2
 #define _ERR_STR_LEN    32
 
 #define _CHOICE_STR_LEN 32
@@ -48,6 +48,12 @@
 
 #define _MAX_FOR_DEPTH  16
 
+// flags for the script line index
+#define _LINE_SKIP(i,s)     (((i) ? 1 : 0) | ((s) ? 2 : 0))
+#define _LINE_SKIP_OK(m)    (1UL<<(m)) // skip[m] is resolved
+#define _LINE_NEXT_OK       (1UL<<4)   // next is resolved
+#define _LINE_LABEL         (1UL<<5)   // line holds a label reachable by find_label()
+
 // macros for textviewer
 #define TV_VPAD         1 // vertical padding per line (above / below)
 #define TV_HPAD         0 // horizontal padding per line (left)
@@ -136,6 +142,15 @@ typedef struct {
 } Gm9ScriptCmd;
 
 typedef struct {
+    char* start; // start of the line inside the script buffer
+    char* skip[4]; // resolved skip_block() targets, by _LINE_SKIP() mode
+    char* next; // resolved find_next() target
+    u32 flags; // _LINE_* flags, see below
+} Gm9ScriptLine;
+
+typedef struct Gm9ScriptVar {
+    struct Gm9ScriptVar* next; // next variable in the same hash bucket
+    bool dynamic; // refreshed via upd_var() on every access
     char name[_VAR_NAME_LEN]; // variable name
     char content[_VAR_CNT_LEN];
 } Gm9ScriptVar;
@@ -217,7 +232,11 @@ static u32 ifcnt = 0;               // current # of 'if' nesting
 
 // script / var buffers
 static void* script_buffer = NULL;
-static void* var_buffer = NULL;
+static Gm9ScriptLine* script_lines = NULL; // line index, built once per script run
+static u32 script_n_lines = 0;
+static bool script_labels_indexed = false;
+static Gm9ScriptVar** var_table = NULL;
+static Gm9ScriptVar* var_null = NULL;
 
 
 static inline bool isntrboot(void) {
@@ -347,6 +366,49 @@ static inline u32 get_lno(const char* text, u32 len, const char* line) {
     return 0;
 }
 
+static bool index_lines(char* script, char* end) {
+    script_n_lines = 0;
+    script_labels_indexed = false;
+    for (char* ptr = script; ptr && (ptr < end); script_n_lines++) {
+        ptr = strchr(ptr, '\n');
+        if (ptr) ptr++;
+    }
+
+    script_lines = (Gm9ScriptLine*) malloc(max(1, script_n_lines) * sizeof(Gm9ScriptLine));
+    if (!script_lines) return false;
+    memset(script_lines, 0x00, max(1, script_n_lines) * sizeof(Gm9ScriptLine));
+
+    char* ptr = script;
+    for (u32 i = 0; i < script_n_lines; i++) {
+        script_lines[i].start = ptr;
+        ptr = strchr(ptr, '\n');
+        if (ptr) ptr++;
+    }
+
+    return true;
+}
+
+static Gm9ScriptLine* get_line(const char* ptr) {
+    if (!script_lines) return NULL;
+
+    // binary search for the line starting at ptr
+    u32 lo = 0;
+    u32 hi = script_n_lines;
+    while (lo < hi) {
+        u32 mid = (lo + hi) / 2;
+        if (script_lines[mid].start == ptr) return script_lines + mid;
+        else if (script_lines[mid].start < ptr) lo = mid + 1;
+        else hi = mid;
+    }
+
+    return NULL; // not at the start of a line
+}
+
+static inline u32 get_script_lno(const char* text, u32 len, const char* line) {
+    Gm9ScriptLine* sline = get_line(line);
+    return sline ? (sline - script_lines) + 1 : get_lno(text, len, line);
+}
+
 void set_preview(const char* name, const char* content) {
     if (strncmp(name, "PREVIEW_MODE", _VAR_NAME_LEN) == 0) {
         if (strncasecmp(content, "quick", _VAR_CNT_LEN) == 0) preview_mode = 1;
@@ -367,27 +429,59 @@ void set_preview(const char* name, const char* content) {
     }
 }
 
-char* set_var(const char* name, const char* content) {
-    Gm9ScriptVar* vars = (Gm9ScriptVar*) var_buffer;
+static inline u32 hash_var(const char* name) {
+    u32 hash = 5381; // djb2
+    for (u32 i = 0; (i < _VAR_NAME_LEN) && name[i]; i++)
+        hash = ((hash << 5) + hash) ^ (u8) name[i];
+    return hash & (_VAR_HASH_SIZE - 1);
+}
+
+static Gm9ScriptVar* find_var(const char* name) {
+    for (Gm9ScriptVar* var = var_table[hash_var(name)]; var; var = var->next)
+        if (strncmp(var->name, name, _VAR_NAME_LEN) == 0) return var;
+    return NULL;
+}
+
+static void free_vars(void) {
+    for (u32 i = 0; i < _VAR_HASH_SIZE; i++) {
+        while (var_table[i]) {
+            Gm9ScriptVar* next = var_table[i]->next;
+            free(var_table[i]);
+            var_table[i] = next;
+        }
+    }
+    var_null = NULL;
+}
 
+char* set_var(const char* name, const char* content) {
     if ((strnlen(name, _VAR_NAME_LEN) > (_VAR_NAME_LEN-1)) || (strnlen(content, _VAR_CNT_LEN) > (_VAR_CNT_LEN-1)) ||
         (strchr(name, '[') || strchr(name, ']')))
         return NULL;
 
-    u32 n_var = 0;
-    for (Gm9ScriptVar* var = vars; n_var < _VAR_MAX_BUFF; n_var++, var++)
-        if (!*(var->name) || (strncmp(var->name, name, _VAR_NAME_LEN) == 0)) break;
-    if (n_var >= _VAR_MAX_BUFF) return NULL;
-    strncpy(vars[n_var].name, name, _VAR_NAME_LEN);
-    vars[n_var].name[_VAR_NAME_LEN - 1] = '\0';
-    strncpy(vars[n_var].content, content, _VAR_CNT_LEN);
-    vars[n_var].content[_VAR_CNT_LEN - 1] = '\0';
-    if (!n_var) *(vars[n_var].content) = '\0'; // NULL var
+    Gm9ScriptVar* var = find_var(name);
+    if (!var) { // new variable
+        u32 hash = hash_var(name);
+        var = (Gm9ScriptVar*) malloc(sizeof(Gm9ScriptVar));
+        if (!var) return NULL;
+        memset(var, 0x00, sizeof(Gm9ScriptVar));
+        strncpy(var->name, name, _VAR_NAME_LEN);
+        var->name[_VAR_NAME_LEN - 1] = '\0';
+        var->next = var_table[hash];
+        var_table[hash] = var;
+        if (!var_null) var_null = var; // first var is the NULL var
+    }
+    strncpy(var->content, content, _VAR_CNT_LEN);
+    var->content[_VAR_CNT_LEN - 1] = '\0';
+    if (var == var_null) *(var->content) = '\0'; // NULL var
 
     // update preview stuff
     set_preview(name, content);
 
-    return vars[n_var].content;
+    return var->content;
+}
+
+static void set_dyn_var(const char* name, const char* content) {
+    if (set_var(name, content)) find_var(name)->dynamic = true;
 }
 
 void upd_var(const char* name) {
@@ -405,8 +499,8 @@ void upd_var(const char* name) {
         else if (*secinfo_data < SMDH_NUM_REGIONS)
             strncpy(env_region, g_regionNamesShort[*secinfo_data], countof(env_region) - 1);
 
-        set_var("SERIAL", env_serial);
-        set_var("REGION", env_region);
+        set_dyn_var("SERIAL", env_serial);
+        set_dyn_var("REGION", env_region);
     }
 
     // device sysnand / emunand id0
@@ -422,7 +516,7 @@ void upd_var(const char* name) {
                 snprintf(env_id0, 32+1, "%08lx%08lx%08lx%08lx",
                     sha256sum[0], sha256sum[1], sha256sum[2], sha256sum[3]);
             } else snprintf(env_id0, 0xF, "UNKNOWN");
-            set_var(env_id0_name, env_id0);
+            set_dyn_var(env_id0_name, env_id0);
         }
     }
 
@@ -434,8 +528,8 @@ void upd_var(const char* name) {
         char env_time[16+1];
         snprintf(env_date, 16, "%02lX%02lX%02lX", (u32) dstime.bcd_Y, (u32) dstime.bcd_M, (u32) dstime.bcd_D);
         snprintf(env_time, 16, "%02lX%02lX%02lX", (u32) dstime.bcd_h, (u32) dstime.bcd_m, (u32) dstime.bcd_s);
-        if (!name || (strncmp(name, "DATESTAMP", _VAR_NAME_LEN) == 0)) set_var("DATESTAMP", env_date);
-        if (!name || (strncmp(name, "TIMESTAMP", _VAR_NAME_LEN) == 0)) set_var("TIMESTAMP", env_time);
+        if (!name || (strncmp(name, "DATESTAMP", _VAR_NAME_LEN) == 0)) set_dyn_var("DATESTAMP", env_date);
+        if (!name || (strncmp(name, "TIMESTAMP", _VAR_NAME_LEN) == 0)) set_dyn_var("TIMESTAMP", env_time);
     }
 
     // emunand base sector
@@ -443,13 +537,11 @@ void upd_var(const char* name) {
         u32 emu_base = GetEmuNandBase();
         char emu_base_str[8+1];
         snprintf(emu_base_str, 8+1, "%08lX", emu_base);
-        set_var("EMUBASE", emu_base_str);
+        set_dyn_var("EMUBASE", emu_base_str);
     }
 }
 
 char* get_var(const char* name, char** endptr) {
-    Gm9ScriptVar* vars = (Gm9ScriptVar*) var_buffer;
-
     u32 name_len = 0;
     char* pname = NULL;
     if (!endptr) { // no endptr, varname is verbatim
@@ -466,21 +558,17 @@ char* get_var(const char* name, char** endptr) {
     char vname[_VAR_NAME_LEN];
     strncpy(vname, pname, name_len);
     vname[name_len] = '\0';
-    upd_var(vname); // handle dynamic env vars
 
-    u32 n_var = 0;
-    for (Gm9ScriptVar* var = vars; n_var < _VAR_MAX_BUFF; n_var++, var++) {
-        if (!*(var->name) || (strncmp(var->name, vname, _VAR_NAME_LEN) == 0)) break;
-    }
-
-    if (n_var >= _VAR_MAX_BUFF || !*(vars[n_var].name)) n_var = 0;
+    Gm9ScriptVar* var = find_var(vname);
+    if (!var) return var_null->content;
+    if (var->dynamic) upd_var(vname); // handle dynamic env vars, updated in place
 
-    return vars[n_var].content;
+    return var->content;
 }
 
 bool init_vars(const char* path_script) {
-    // reset var buffer
-    memset(var_buffer, 0x00, sizeof(Gm9ScriptVar) * _VAR_MAX_BUFF);
+    // reset var table
+    free_vars();
 
     // current path
     char curr_dir[_VAR_CNT_LEN];
@@ -493,6 +581,7 @@ bool init_vars(const char* path_script) {
 
     // set env vars
     set_var("NULL", ""); // this one is special and should not be changed later
+    if (!var_null) return false; // get_var() relies on this one
     set_var("CURRDIR", curr_dir); // script path, never changes
     set_var("GM9OUT", OUTPUT_PATH); // output path, never changes
     set_var("HAX", IS_UNLOCKED ? (isntrboot() ? "ntrboot" : "sighax") : ""); // type of hax running from
@@ -613,7 +702,9 @@ char* get_string(char* ptr, const char* line_end, u32* len, char** next, char* e
     return str;
 }
 
-char* skip_block(char* ptr, bool ignore_else, bool stop_after_end) {
+char* skip_block(char* ptr, bool ignore_else, bool stop_after_end);
+
+char* skip_block_worker(char* ptr, bool ignore_else, bool stop_after_end) {
     while (*ptr) {
         // store line start / line end
         char* line_start = ptr;
@@ -656,7 +747,22 @@ char* skip_block(char* ptr, bool ignore_else, bool stop_after_end) {
     return NULL;
 }
 
-char* find_next(char* ptr) {
+char* skip_block(char* ptr, bool ignore_else, bool stop_after_end) {
+    // the script never changes while it runs, so each target is resolved only once
+    Gm9ScriptLine* line = get_line(ptr);
+    u32 mode = _LINE_SKIP(ignore_else, stop_after_end);
+    if (line && (line->flags & _LINE_SKIP_OK(mode))) return line->skip[mode];
+
+    char* skip_ptr = skip_block_worker(ptr, ignore_else, stop_after_end);
+    if (line) {
+        line->skip[mode] = skip_ptr;
+        line->flags |= _LINE_SKIP_OK(mode);
+    }
+
+    return skip_ptr;
+}
+
+char* find_next_worker(char* ptr) {
     while (ptr && *ptr) {
         // store line start / line end
         char* line_start = ptr;
@@ -689,11 +795,67 @@ char* find_next(char* ptr) {
     return NULL;
 }
 
+char* find_next(char* ptr) {
+    Gm9ScriptLine* line = get_line(ptr);
+    if (line && (line->flags & _LINE_NEXT_OK)) return line->next;
+
+    char* next_ptr = find_next_worker(ptr);
+    if (line) {
+        line->next = next_ptr;
+        line->flags |= _LINE_NEXT_OK;
+    }
+
+    return next_ptr;
+}
+
+static void index_labels(void) {
+    // mark all labels find_label() can reach, that is all outside of 'if' and 'for' blocks
+    char* ptr = (char*) script_buffer;
+    char* next = ptr;
+    for (; next && *ptr; ptr = next) {
+        char* line_start = ptr;
+        char* line_end = strchr(ptr, '\n');
+        if (!line_end) line_end = ptr + strlen(ptr);
+        next = line_end + 1;
+
+        char* str = NULL;
+        u32 str_len = 0;
+        if (!(str = get_string(ptr, line_end, &str_len, &ptr, NULL))) continue; // string error, ignore line
+        else if (str >= line_end) continue; // empty line
+
+        if (*str == '@') {
+            Gm9ScriptLine* line = get_line(line_start);
+            if (line) line->flags |= _LINE_LABEL;
+        } else if (MATCH_STR(str, str_len, _CMD_IF)) {
+            next = skip_block(line_start, true, true);
+        } else if (MATCH_STR(str, str_len, _CMD_FOR)) {
+            next = find_next(line_start);
+        }
+    }
+
+    script_labels_indexed = true;
+}
+
+static char* next_label_line(char* ptr) {
+    // next line that could hold a label, uses the label index if available
+    if (script_lines) {
+        Gm9ScriptLine* line = get_line(ptr);
+        if (!line) return NULL;
+        for (; line < script_lines + script_n_lines; line++)
+            if (line->flags & _LINE_LABEL) return line->start;
+        return NULL;
+    }
+    return ptr;
+}
+
 char* find_label(const char* label, const char* last_found) {
     char* script = (char*) script_buffer;
     char* ptr = script;
     u32 label_len = strnlen(label, _ARG_MAX_LEN);
 
+    if (script_lines && !script_labels_indexed)
+        index_labels();
+
     if (last_found) {
         ptr = strchr(last_found, '\n');
         if (!ptr) return NULL;
@@ -702,6 +864,9 @@ char* find_label(const char* label, const char* last_found) {
 
     char* next = ptr;
     for (; next && *ptr; ptr = next) {
+        // jump ahead to the next indexed label
+        if (!(ptr = next_label_line(ptr))) break;
+
         // store line start / get line end
         char* line_start = ptr;
         char* line_end = strchr(ptr, '\n');
@@ -1814,13 +1979,13 @@ bool ExecuteGM9Script(const char* path_script) {
 
 
     // allocate && check memory
-    var_buffer = (void*) malloc(sizeof(Gm9ScriptVar) * _VAR_MAX_BUFF);
+    var_table = (Gm9ScriptVar**) malloc(sizeof(Gm9ScriptVar*) * _VAR_HASH_SIZE);
     script_buffer = (void*) malloc(SCRIPT_MAX_SIZE);
     char* script = (char*) script_buffer;
     char* ptr = script;
 
-    if (!var_buffer || !script_buffer) {
-        if (var_buffer) free(var_buffer);
+    if (!var_table || !script_buffer) {
+        if (var_table) free(var_table);
         if (script_buffer) free(script_buffer);
         ShowPrompt(false, "Out of memory.");
         return false;
@@ -1829,7 +1994,7 @@ bool ExecuteGM9Script(const char* path_script) {
     // fetch script from path
     u32 script_size = FileGetData(path_script, (u8*) script, SCRIPT_MAX_SIZE, 0);
     if (!script_size || (script_size >= SCRIPT_MAX_SIZE)) {
-        free(var_buffer);
+        free(var_table);
         free(script_buffer);
         return false;
     }
@@ -1837,8 +2002,20 @@ bool ExecuteGM9Script(const char* path_script) {
     char* end = script + script_size;
     *end = '\0';
 
+    // index script lines (for quicker jumps, works without, too)
+    index_lines(script, end);
+
     // initialise variables
-    init_vars(path_script);
+    memset(var_table, 0x00, sizeof(Gm9ScriptVar*) * _VAR_HASH_SIZE);
+    if (!init_vars(path_script)) {
+        free_vars();
+        free(var_table);
+        free(script_lines);
+        free(script_buffer);
+        script_lines = NULL;
+        ShowPrompt(false, "Out of memory.");
+        return false;
+    }
 
     // setup script preview (only if used)
     u32 preview_mode_local = 0;
@@ -1975,10 +2152,10 @@ bool ExecuteGM9Script(const char* path_script) {
         // reposition pointer
         if (skip_ptr != ptr) {
             ptr = skip_ptr;
-            lno = get_lno(script, script_size, ptr);
+            lno = get_script_lno(script, script_size, ptr);
         } else if (jump_ptr) {
             ptr = jump_ptr;
-            lno = get_lno(script, script_size, ptr);
+            lno = get_script_lno(script, script_size, ptr);
             ifcnt = 0; // jumping into conditional block is unexpected/unsupported
             jump_ptr = NULL;
             for_ptr = NULL;
@@ -2008,7 +2185,10 @@ bool ExecuteGM9Script(const char* path_script) {
     }
 
 
-    free(var_buffer);
+    free_vars();
+    free(var_table);
+    free(script_lines);
     free(script_buffer);
+    script_lines = NULL;
     return result;
 }
@@ -7,6 +7,10 @@
 #include "sdmmc.h" // for NAND / SD CID
 #include "vff.h"
 #include "sha.h"
+#ifdef MONITOR_HEAP
+#include "nand.h" // for cache stats
+#include "aes.h"
+#endif
 #include <ctype.h>
 #include <limits.h>
 #include <string.h>
@@ -611,4 +615,13 @@ void MyriaSysinfo(char* sysinfo_txt) {
     MeowSprintf(meow, "SD CID: %s\r\n", info.sd_cid);
     MeowSprintf(meow, "System ID0: %s\r\n", info.nand_id0);
     MeowSprintf(meow, "System ID1: %s\r\n", info.nand_id1);
+#ifdef MONITOR_HEAP
+    u32 hits, misses;
+    GetNandCacheStats(&hits, &misses);
+    MeowSprintf(meow, "\r\n");
+    MeowSprintf(meow, "NAND sector cache: %lu hits / %lu misses\r\n", hits, misses);
+    u32 loads, skipped;
+    aeskey_cache_stats(&loads, &skipped);
+    MeowSprintf(meow, "AES keyY setups: %lu loaded / %lu skipped\r\n", loads, skipped);
+#endif
 }
@@ -118,17 +118,27 @@ static ExeFsHeader* exefs = NULL;
 static RomFsLv3Index lv3idx;
 static u8 cia_titlekey[16];
 
+// CBC chain / keyslot state, carried over between sequential reads
+static u64 cbc_next_block = (u64) -1;
+static u8 cbc_next_iv[AES_BLOCK_SIZE];
+static u32 cia_titlekey_state = 0;
+
 
 int ReadCbcImageBlocks(void* buffer, u64 block, u64 count, u8* iv0, u64 block0) {
     int ret = ReadImageBytes(buffer, block * AES_BLOCK_SIZE, count * AES_BLOCK_SIZE);
     if ((ret == 0) && iv0) {
         u8 ctr[AES_BLOCK_SIZE] = { 0 };
         if (block == block0) memcpy(ctr, iv0, AES_BLOCK_SIZE);
+        else if (block == cbc_next_block) memcpy(ctr, cbc_next_iv, AES_BLOCK_SIZE);
         else if ((ret = ReadImageBytes(ctr, (block-1) * AES_BLOCK_SIZE, AES_BLOCK_SIZE)) != 0)
             return ret;
 
         u32 mode = AES_CNT_TITLEKEY_DECRYPT_MODE;
         cbc_decrypt(buffer, buffer, count, mode, ctr);
+
+        // ctr now holds the last ciphertext block, the IV for the next one
+        memcpy(cbc_next_iv, ctr, AES_BLOCK_SIZE);
+        cbc_next_block = block + count;
     }
     return ret;
 }
@@ -170,10 +180,13 @@ int ReadCbcImageBytes(void* buffer, u64 offset, u64 count, u8* iv0, u64 offset0)
 }
 
 int ReadCiaContentImageBytes(void* buffer, u64 offset, u64 count, u32 cia_cnt_idx, u64 offset0) {
-    // setup key for CIA
-    u8 tik[16] __attribute__((aligned(32)));
-    memcpy(tik, cia_titlekey, 16);
-    setup_aeskey(0x11, tik);
+    // setup key for CIA (skipped if still in the keyslot)
+    if (!cia_titlekey_state || (aeskey_state(0x11) != cia_titlekey_state)) {
+        u8 tik[16] __attribute__((aligned(32)));
+        memcpy(tik, cia_titlekey, 16);
+        setup_aeskey(0x11, tik);
+        cia_titlekey_state = aeskey_state(0x11);
+    }
     use_aeskey(0x11);
 
     // setup IV0
@@ -762,6 +775,9 @@ u64 InitVGameDrive(void) { // prerequisite: game file mounted as image
     offset_nitro = (u64) -1;
     offset_tad   = (u64) -1;
 
+    cbc_next_block = (u64) -1;
+    cia_titlekey_state = 0;
+
     base_vdir =
         (type & SYS_FIRM  ) ? VFLAG_FIRM  :
         (type & GAME_CIA  ) ? VFLAG_CIA   :
@@ -849,6 +865,7 @@ bool OpenVGameDir(VirtualDir* vdir, VirtualFile* ventry) {
             return false;
         offset_cia = vdir->offset; // always zero(!)
         GetTitleKey(cia_titlekey, (Ticket*)&(cia->ticket));
+        cia_titlekey_state = 0;
         if (!BuildVGameCiaDir()) return false;
     } else if ((vdir->flags & VFLAG_NCSD) && (offset_ncsd != vdir->offset)) {
         if ((ReadImageBytes((u8*) ncsd, 0, sizeof(NcsdHeader)) != 0) ||
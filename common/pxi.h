@@ -39,7 +39,9 @@ enum {
 	PXI_NVRAM_READ,
 
 	PXI_NOTIFY_LED,
-	PXI_BRIGHTNESS
+	PXI_BRIGHTNESS,
+
+	PXI_JOB_NOTIFY
 };
 
 /*
@@ -23,7 +23,40 @@
 #define I2C_SHARED_BUFSZ 1024
 #define SPI_SHARED_BUFSZ 1024
 
+#define JOB_QUEUE_SLOTS 16
+#define JOB_DATA_SIZE 8
+
+/* Jobs the ARM9 can offload to the ARM11 */
+enum {
+	JOB_NOP = 0,
+	JOB_I2C_READ, // args: device, register, length (data returned inline)
+	JOB_I2C_WRITE, // args: device, register, length (data passed inline)
+};
+
 typedef struct {
+	u32 type;
+	u32 flags;
+	u32 args[3];
+	u32 result;
+	u8 data[JOB_DATA_SIZE]; // small inline payload, one job per cache line
+} __attribute__((packed, aligned(32))) SystemJob;
+
+/*
+ * Single producer (ARM9), single consumer (ARM11) ring
+ * head and tail live in separate cache lines, each one
+ * is only ever written by one side
+ */
+typedef struct {
+	vu32 head;
+	u32 padding0[7];
+	vu32 tail;
+	u32 padding1[7];
+	SystemJob slot[JOB_QUEUE_SLOTS];
+} __attribute__((packed, aligned(32))) SystemJobQueue;
+
+typedef struct {
+	SystemJobQueue jobQueue; // first, so it stays cache line aligned
+
 	union {
 		struct { u32 keys, touch; };
 		u64 full;
@@ -31,7 +64,7 @@ typedef struct {
 
 	u8 i2cBuffer[I2C_SHARED_BUFSZ];
 	u32 spiBuffer[SPI_SHARED_BUFSZ/4];
-} __attribute__((packed, aligned(8))) SystemSHMEM;
+} __attribute__((packed, aligned(32))) SystemSHMEM;
 
 #ifdef ARM9
 #include <pxi.h>
@@ -0,0 +1,178 @@
+// backwards code LZSS decoder (game/codelzss.c) against the bytewise one it replaced
+// - compressed with CompressCodeLzss(), then mutated or replaced by random bytes:
+//   return codes, sizes and the whole buffer have to match the reference decoder
+// - throughput of both on a synthetic 4 MiB "executable"
+
+#include "test.h"
+#include "codelzss.c"
+
+#define BENCH_SIZE  (4 << 20)
+#define FUZZ_SIZE   20000
+#define N_FUZZ      20000
+#define HEADROOM    16 // the reference decoder may read in front of the buffer
+
+bool ShowProgress(u64 current, u64 total, const char* opstr) {
+    (void) current;
+    (void) total;
+    (void) opstr;
+    return true;
+}
+
+bool ShowPrompt(bool ask, const char *format, ...) {
+    (void) ask;
+    (void) format;
+    return false;
+}
+
+// the decoder as it was, one byte at a time, without progress display
+static u32 RefDecompressCodeLzss(u8* code, u32* code_size, u32 max_size) {
+    u8* data_start = code;
+    u8* comp_start = data_start;
+
+    if ((*code_size < sizeof(CodeLzssFooter)) || (*code_size > max_size)) return 1;
+    CodeLzssFooter* footer = (CodeLzssFooter*) (void*) (data_start + *code_size - sizeof(CodeLzssFooter));
+    if (CODE_COMP_SIZE(footer) <= *code_size) comp_start += *code_size - CODE_COMP_SIZE(footer);
+    else return 1;
+
+    if ((CODE_COMP_END(footer) < 0) || (CODE_DEC_SIZE(footer) > max_size))
+        return 1;
+
+    u8* data_end = (u8*) comp_start + CODE_DEC_SIZE(footer);
+    u8* ptr_in = (u8*) comp_start + CODE_COMP_END(footer);
+    u8* ptr_out = data_end;
+
+    while ((ptr_in > comp_start) && (ptr_out > comp_start)) {
+        if (ptr_out < ptr_in) return 1;
+
+        u8 ctrlbyte = *(--ptr_in);
+        for (int i = 7; i >= 0; i--) {
+            if ((ptr_in <= comp_start) || (ptr_out <= comp_start))
+                break;
+
+            if ((ctrlbyte >> i) & 0x1) {
+                ptr_in -= 2;
+                u16 seg_code = getle16(ptr_in);
+                if (ptr_in < comp_start) return 1;
+                u32 seg_off = CODE_SEG_OFFSET(seg_code);
+                u32 seg_len = CODE_SEG_SIZE(seg_code);
+
+                if ((ptr_out - seg_len < comp_start) || (ptr_out + seg_off >= data_end))
+                    return 1;
+
+                for (u32 c = 0; c < seg_len; c++) {
+                    u8 byte = *(ptr_out + seg_off);
+                    *(--ptr_out) = byte;
+                }
+            } else {
+                if ((ptr_out == comp_start) || (ptr_in == comp_start))
+                    return 1;
+                *(--ptr_out) = *(--ptr_in);
+            }
+        }
+    }
+
+    if ((ptr_in != comp_start) || (ptr_out != comp_start))
+        return 1;
+
+    *code_size = data_end - data_start;
+    return 0;
+}
+
+// code-like data: repeated words, copies from not too far back, zero runs
+static void make_code(u8* data, u32 size, unsigned int* seed) {
+    u32 vocab[512];
+    for (u32 i = 0; i < countof(vocab); i++)
+        vocab[i] = test_rand(seed) * 2654435761u;
+
+    u32 i = 0;
+    while (i + 4 <= size) {
+        u32 r = test_rand(seed) % 10;
+        if (r < 6) {
+            u32 w = vocab[test_rand(seed) % ((r < 3) ? 64 : 512)];
+            memcpy(data + i, &w, 4);
+            i += 4;
+        } else if ((r < 8) && (i > 4100)) {
+            u32 dist = 4 + (test_rand(seed) % 4000);
+            u32 len = min(4 + (test_rand(seed) % 40), size - i);
+            memmove(data + i, data + i - dist, len);
+            i += len;
+        } else if (r < 9) {
+            u32 len = min(test_rand(seed) % 32, size - i);
+            memset(data + i, 0, len);
+            i += len;
+        } else data[i++] = test_rand(seed);
+    }
+    while (i < size) data[i++] = test_rand(seed);
+}
+
+int main(void) {
+    unsigned int seed = 1;
+    u8* data = malloc(BENCH_SIZE);
+    u8* comp = malloc(BENCH_SIZE + 64);
+    u8* buf_ref = malloc(BENCH_SIZE + 64 + HEADROOM);
+    u8* buf_new = malloc(BENCH_SIZE + 64 + HEADROOM);
+    u8* out_ref = buf_ref + HEADROOM;
+    u8* out_new = buf_new + HEADROOM;
+
+    // benchmark, on a valid stream
+    make_code(data, BENCH_SIZE, &seed);
+    u32 comp_size = BENCH_SIZE;
+    CHECK(CompressCodeLzss(data, BENCH_SIZE, comp, &comp_size), "can't compress");
+
+    memcpy(out_ref, comp, comp_size);
+    u32 size_ref = comp_size;
+    double t0 = test_seconds();
+    u32 res_ref = RefDecompressCodeLzss(out_ref, &size_ref, BENCH_SIZE + 64);
+    double t_ref = test_seconds() - t0;
+
+    memcpy(out_new, comp, comp_size);
+    u32 size_new = comp_size;
+    t0 = test_seconds();
+    u32 res_new = DecompressCodeLzss(out_new, &size_new, BENCH_SIZE + 64);
+    double t_new = test_seconds() - t0;
+
+    CHECK((res_ref == 0) && (size_ref == BENCH_SIZE) && (memcmp(out_ref, data, BENCH_SIZE) == 0),
+        "reference decoder fails on a valid stream");
+    CHECK((res_new == 0) && (size_new == BENCH_SIZE) && (memcmp(out_new, data, BENCH_SIZE) == 0),
+        "decoder fails on a valid stream");
+    printf("%u MiB (%.1f%% compressed): %.0f MiB/s, reference %.0f MiB/s\n", BENCH_SIZE >> 20,
+        100.0 * comp_size / BENCH_SIZE, (BENCH_SIZE >> 20) / t_new, (BENCH_SIZE >> 20) / t_ref);
+
+    // fuzz, mutated and random streams
+    u32 n_valid = 0;
+    for (u32 i = 0; i < N_FUZZ; i++) {
+        u32 size = 16 + (test_rand(&seed) % FUZZ_SIZE);
+        make_code(data, size, &seed);
+        comp_size = size;
+        if (!CompressCodeLzss(data, size, comp, &comp_size)) continue;
+
+        u32 mutations = test_rand(&seed) % 4;
+        for (u32 m = 0; m < mutations; m++)
+            comp[test_rand(&seed) % comp_size] ^= 1 << (test_rand(&seed) % 8);
+        if (test_rand(&seed) % 8 == 0) {
+            for (u32 k = 0; k < comp_size; k++)
+                comp[k] = test_rand(&seed);
+        }
+
+        u32 max_size = size + 64;
+        memset(buf_ref, 0xAA, max_size + HEADROOM);
+        memset(buf_new, 0xAA, max_size + HEADROOM);
+        memcpy(out_ref, comp, comp_size);
+        memcpy(out_new, comp, comp_size);
+        size_ref = size_new = comp_size;
+        res_ref = RefDecompressCodeLzss(out_ref, &size_ref, max_size);
+        res_new = DecompressCodeLzss(out_new, &size_new, max_size);
+        if (!res_ref) n_valid++;
+
+        CHECK((res_ref == res_new) && (size_ref == size_new) && (memcmp(buf_ref, buf_new, max_size + HEADROOM) == 0),
+            "stream %lu (%lu bytes, %lu mutations): returned %lu, reference %lu", (unsigned long) i,
+            (unsigned long) comp_size, (unsigned long) mutations, (unsigned long) res_new, (unsigned long) res_ref);
+    }
+    printf("%u streams fuzzed, %lu of them decoded\n", N_FUZZ, (unsigned long) n_valid);
+
+    free(data);
+    free(comp);
+    free(buf_ref);
+    free(buf_new);
+    return test_result("codelzss_test");
+}
@@ -0,0 +1,107 @@
+// CRC32 (crypto/crc32.c), slice-by-8 against the bytewise table it replaced
+// - random buffers, offsets and lengths, against crc32_adjust() one byte at a
+//   time and a bitwise reference, plus the standard check value
+// - crc32_combine() for random splits
+// - crc32_calculate_from_file() over a memory file, across buffer boundaries
+// - throughput of both
+
+#include "test.h"
+#include "crc32.h"
+#include "vff.h"
+
+#define FILE_SIZE   (STD_BUFFER_SIZE * 2 + 0x1234)
+#define BENCH_SIZE  (16 << 20)
+#define N_CHECKS    20000
+
+static u8* host_file = NULL;
+
+FRESULT fvx_open(FIL* fp, const TCHAR* path, BYTE mode) {
+    if ((strncmp(path, "T:/file", 256) != 0) || (mode != FA_READ)) return FR_NO_FILE;
+    fp->fptr = 0;
+    return FR_OK;
+}
+
+FRESULT fvx_lseek(FIL* fp, FSIZE_t ofs) {
+    fp->fptr = ofs;
+    return FR_OK;
+}
+
+FRESULT fvx_read(FIL* fp, void* buff, UINT btr, UINT* br) {
+    UINT len = (fp->fptr < FILE_SIZE) ? min(btr, FILE_SIZE - fp->fptr) : 0;
+    memcpy(buff, host_file + fp->fptr, len);
+    fp->fptr += len;
+    *br = len;
+    return FR_OK;
+}
+
+FRESULT fvx_close(FIL* fp) {
+    (void) fp;
+    return FR_OK;
+}
+
+static u32 crc32_bytewise(u32 crc, const u8* data, u32 length) {
+    while (length--) crc = crc32_adjust(crc, *(data++));
+    return crc;
+}
+
+static u32 crc32_bitwise(u32 crc, const u8* data, u32 length) {
+    while (length--) {
+        crc ^= *(data++);
+        for (u32 b = 0; b < 8; b++)
+            crc = (crc >> 1) ^ ((crc & 1) ? 0xEDB88320 : 0);
+    }
+    return crc;
+}
+
+int main(void) {
+    unsigned int seed = 1;
+    u8* data = malloc(BENCH_SIZE + 16);
+    for (u32 i = 0; i < BENCH_SIZE + 16; i++)
+        data[i] = test_rand(&seed);
+
+    CHECK(~crc32_calculate(~0, (const u8*) "123456789", 9) == 0xCBF43926, "check value is wrong");
+    CHECK(crc32_calculate(0x12345678, data, 0) == 0x12345678, "empty input changes the CRC");
+
+    for (u32 i = 0; i < N_CHECKS; i++) {
+        u32 offset = test_rand(&seed) % 16;
+        u32 length = test_rand(&seed) % ((i % 16) ? 64 : 0x4000);
+        u32 init = (i % 2) ? ~0 : test_rand(&seed);
+        u32 crc = crc32_calculate(init, data + offset, length);
+        CHECK(crc == crc32_bytewise(init, data + offset, length), "+%lu, %lu bytes: %08lX (bytewise %08lX)",
+            (unsigned long) offset, (unsigned long) length, (unsigned long) crc,
+            (unsigned long) crc32_bytewise(init, data + offset, length));
+        if (i % 8 == 0) CHECK(crc == crc32_bitwise(init, data + offset, length), "+%lu, %lu bytes: bitwise mismatch",
+            (unsigned long) offset, (unsigned long) length);
+
+        u32 split = test_rand(&seed) % (length + 1);
+        u32 crc1 = ~crc32_calculate(~0, data + offset, split);
+        u32 crc2 = ~crc32_calculate(~0, data + offset + split, length - split);
+        CHECK(crc32_combine(crc1, crc2, length - split) == ~crc32_calculate(~0, data + offset, length),
+            "combine %lu + %lu bytes", (unsigned long) split, (unsigned long) (length - split));
+    }
+    u32 crc_zero = ~crc32_calculate(~0, data, 0);
+    CHECK(crc32_combine(0x12345678, crc_zero, 0) == 0x12345678, "combine with nothing");
+
+    host_file = data;
+    static const u32 ranges[][2] = {
+        { 0, FILE_SIZE }, { 1, FILE_SIZE - 1 }, { 0x1FF, STD_BUFFER_SIZE }, { 7, STD_BUFFER_SIZE + 1 }, { 3, 5 }
+    };
+    for (u32 i = 0; i < countof(ranges); i++) {
+        u32 crc = crc32_calculate_from_file("T:/file", ranges[i][0], ranges[i][1]);
+        CHECK(crc == ~crc32_bytewise(~0, data + ranges[i][0], ranges[i][1]), "file CRC of +%lu, %lu bytes",
+            (unsigned long) ranges[i][0], (unsigned long) ranges[i][1]);
+    }
+
+    double t0 = test_seconds();
+    u32 crc_old = crc32_bytewise(~0, data, BENCH_SIZE);
+    double t_old = test_seconds() - t0;
+    t0 = test_seconds();
+    u32 crc_new = crc32_calculate(~0, data, BENCH_SIZE);
+    double t_new = test_seconds() - t0;
+    CHECK(crc_old == crc_new, "benchmark CRCs differ");
+    printf("%u MiB: slice-by-8 %.0f MiB/s, bytewise %.0f MiB/s\n", BENCH_SIZE >> 20,
+        (BENCH_SIZE >> 20) / t_new, (BENCH_SIZE >> 20) / t_old);
+
+    free(data);
+    return test_result("crc32_test");
+}
@@ -0,0 +1,208 @@
+// deferred IVFC rehash (game/disadiff.c) against the old per-write rehash
+// - a synthetic DISA style image in memory, with DPFS lvl3 and IVFC levels 1 ... 4
+// - random writes to IVFC lvl4, hashes fixed after every write (old way) or once
+//   from the dirty bitmaps (new way), both images have to come out the same
+// - the result also has to match a full rehash from scratch
+
+#include "test.h"
+#include "disadiff.c"
+
+#define IMAGE_SIZE      0x320000
+#define N_WRITES        64
+
+// mounted image stand-in, DisaDiffRead() / DisaDiffWrite() end up here
+static u8* host_image = NULL;
+
+int ReadImageBytes(void* buffer, u64 offset, u64 count) {
+    if (offset + count > IMAGE_SIZE) return 1;
+    memcpy(buffer, host_image + offset, count);
+    return 0;
+}
+
+int WriteImageBytes(const void* buffer, u64 offset, u64 count) {
+    if (offset + count > IMAGE_SIZE) return 1;
+    memcpy(host_image + offset, buffer, count);
+    return 0;
+}
+
+u64 GetMountState(void) {
+    return 1;
+}
+
+u64 GetMountSize(void) {
+    return IMAGE_SIZE;
+}
+
+// the per-write rehash, as it was before the dirty bitmaps
+static u32 OldFixDisaDiffIvfcLevel(const DisaDiffRWInfo* info, u32 level, u32 offset, u32 size, u32* next_offset, u32* next_size) {
+    if (level == 0)
+        return FixDisaDiffPartitionHash(info);
+
+    if (level > 4)
+        return 1;
+
+    const u32 offset_ivfc_lvl = (&(info->offset_ivfc_lvl1))[level - 1];
+    const u32 size_ivfc_lvl = (&(info->size_ivfc_lvl1))[level - 1];
+    const u32 log_ivfc_lvl = (&(info->log_ivfc_lvl1))[level - 1];
+    const u32 block_size = 1 << log_ivfc_lvl;
+    u32 read_size = block_size;
+    u32 align_offset = (offset >> log_ivfc_lvl) << log_ivfc_lvl; // align starting offset
+    u32 align_size = size + offset - align_offset; // increase size by the amount starting offset decreased when aligned
+
+    if (level != 1) {
+        if (next_offset) *next_offset = (align_offset >> log_ivfc_lvl) * 0x20;
+        if (next_size) *next_size = ((align_size >> log_ivfc_lvl) + (((align_size % block_size) == 0) ? 0 : 1)) * 0x20;
+    }
+
+    u8 sha_buf[0x20];
+    u8* buf;
+
+    if (!(buf = malloc(block_size)))
+        return 1;
+
+    while (align_size > 0) {
+        if (align_offset + block_size > size_ivfc_lvl) {
+            memset(buf, 0, block_size);
+            read_size -= (align_offset + block_size - size_ivfc_lvl);
+        }
+
+        if (((level == 4) && info->ivfc_use_extlvl4) ? (DisaDiffRead(buf, read_size, align_offset + offset_ivfc_lvl) != FR_OK) :
+            (ReadDisaDiffDpfsLvl3(info, align_offset + offset_ivfc_lvl, read_size, buf) != read_size)) {
+            free(buf);
+            return 1;
+        }
+
+        sha_quick(sha_buf, buf, block_size, SHA256_MODE);
+
+        if ((level == 1) ? (DisaDiffWrite(sha_buf, 0x20, info->offset_difi + info->offset_master_hash + ((align_offset >> log_ivfc_lvl) * 0x20)) != FR_OK) :
+            (WriteDisaDiffDpfsLvl3(info, (&(info->offset_ivfc_lvl1))[level - 2] + ((align_offset >> log_ivfc_lvl) * 0x20), 0x20, sha_buf) != 0x20)) {
+            free(buf);
+            return 1;
+        }
+
+        align_offset += block_size;
+        align_size = ((align_size < block_size) ? 0 : (align_size - block_size));
+    }
+
+    free(buf);
+
+    return 0;
+}
+
+static u32 OldFixHashChain(const DisaDiffRWInfo* info, u32 offset, u32 size) {
+    for (int i = 4; i >= 0; i--)
+        if (OldFixDisaDiffIvfcLevel(info, i, offset, size, &offset, &size) != 0) return 1;
+    return 0;
+}
+
+// lvl4 is 256 blocks of 4KiB (last one partial), lvl1 ... lvl3 use 512 byte blocks
+static void setup_info(DisaDiffRWInfo* info, u8* lvl2_cache, bool extlvl4, unsigned int* seed) {
+    memset(info, 0x00, sizeof(DisaDiffRWInfo));
+    info->offset_table = 0x200;
+    info->size_table = 0x200;
+    info->offset_partition_hash = 0x16C;
+    info->offset_difi = 0x200;
+    info->offset_master_hash = 0x10C;
+
+    info->log_ivfc_lvl1 = info->log_ivfc_lvl2 = info->log_ivfc_lvl3 = 9;
+    info->log_ivfc_lvl4 = 12;
+    info->size_ivfc_lvl4 = 0x100000 - 1000;
+    info->size_ivfc_lvl3 = 256 * 0x20;
+    info->size_ivfc_lvl2 = 16 * 0x20;
+    info->size_ivfc_lvl1 = 1 * 0x20;
+    info->offset_ivfc_lvl1 = 0x0;
+    info->offset_ivfc_lvl2 = 0x200;
+    info->offset_ivfc_lvl3 = 0x1000;
+    info->offset_ivfc_lvl4 = extlvl4 ? 0x210000 : 0x4000; // relative to file start if external
+    info->ivfc_use_extlvl4 = extlvl4;
+
+    info->offset_dpfs_lvl3 = 0x1000;
+    info->size_dpfs_lvl3 = extlvl4 ? 0x4000 : 0x104000;
+    info->log_dpfs_lvl3 = 12;
+
+    // random partition selection for each DPFS lvl3 block
+    for (u32 i = 0; i < 0x200; i++)
+        lvl2_cache[i] = test_rand(seed);
+    info->dpfs_lvl2_cache = lvl2_cache;
+}
+
+static void run(bool extlvl4) {
+    const char* name = extlvl4 ? "external lvl4" : "lvl4 in DPFS";
+    unsigned int seed = extlvl4 ? 2 : 1;
+    static u8 lvl2_cache[0x200];
+    DisaDiffRWInfo info;
+    setup_info(&info, lvl2_cache, extlvl4, &seed);
+
+    u8* image_old = malloc(IMAGE_SIZE);
+    u8* image_new = malloc(IMAGE_SIZE);
+    u8* image_full = malloc(IMAGE_SIZE);
+    u8* data = malloc(0x10000);
+    for (u32 i = 0; i < IMAGE_SIZE; i++)
+        image_old[i] = test_rand(&seed);
+
+    // consistent starting point
+    host_image = image_old;
+    CHECK(OldFixHashChain(&info, 0, info.size_ivfc_lvl4) == 0, "%s: initial rehash failed", name);
+    memcpy(image_new, image_old, IMAGE_SIZE);
+
+    DisaDiffIvfcDirty dirty;
+    CHECK(InitDisaDiffIvfcDirty(&info, &dirty) == 0, "%s: can't set up the dirty bitmaps", name);
+
+    double t_old = 0, t_new = 0;
+    for (u32 w = 0; w < N_WRITES; w++) {
+        u32 offset = test_rand(&seed) % info.size_ivfc_lvl4;
+        u32 size = 1 + (test_rand(&seed) % ((w % 4) ? 0x1000 : 0x10000));
+        if (offset + size > info.size_ivfc_lvl4) size = info.size_ivfc_lvl4 - offset;
+        for (u32 i = 0; i < size; i++)
+            data[i] = test_rand(&seed);
+
+        host_image = image_old;
+        double t0 = test_seconds();
+        CHECK(WriteDisaDiffIvfcLvl4Open(&info, offset, size, data) == size, "%s: write %lu failed", name, (unsigned long) w);
+        CHECK(OldFixHashChain(&info, offset, size) == 0, "%s: rehash %lu failed", name, (unsigned long) w);
+        t_old += test_seconds() - t0;
+
+        host_image = image_new;
+        t0 = test_seconds();
+        CHECK(WriteDisaDiffIvfcLvl4Open(&info, offset, size, data) == size, "%s: write %lu failed", name, (unsigned long) w);
+        MarkDisaDiffIvfcDirty(&info, &dirty, offset, size);
+        t_new += test_seconds() - t0;
+    }
+
+    host_image = image_new;
+    double t0 = test_seconds();
+    CHECK(FixDisaDiffIvfcDirty(&info, &dirty) == 0, "%s: deferred rehash failed", name);
+    t_new += test_seconds() - t0;
+    CHECK(!dirty.is_dirty, "%s: still dirty", name);
+    FreeDisaDiffIvfcDirty(&dirty);
+
+    CHECK(memcmp(image_old, image_new, IMAGE_SIZE) == 0, "%s: deferred rehash differs from per-write rehash", name);
+
+    // the whole chain is consistent, too
+    memcpy(image_full, image_new, IMAGE_SIZE);
+    host_image = image_full;
+    CHECK(OldFixHashChain(&info, 0, info.size_ivfc_lvl4) == 0, "%s: full rehash failed", name);
+    CHECK(memcmp(image_full, image_new, IMAGE_SIZE) == 0, "%s: full rehash differs", name);
+
+    printf("%s: %u writes, per-write rehash %.2f ms, deferred rehash %.2f ms\n", name, N_WRITES, t_old * 1e3, t_new * 1e3);
+
+    free(image_old);
+    free(image_new);
+    free(image_full);
+    free(data);
+}
+
+int main(void) {
+    // the software SHA-256 is the real thing
+    static const u8 sha_abc[0x20] = {
+        0xba, 0x78, 0x16, 0xbf, 0x8f, 0x01, 0xcf, 0xea, 0x41, 0x41, 0x40, 0xde, 0x5d, 0xae, 0x22, 0x23,
+        0xb0, 0x03, 0x61, 0xa3, 0x96, 0x17, 0x7a, 0x9c, 0xb4, 0x10, 0xff, 0x61, 0xf2, 0x00, 0x15, 0xad
+    };
+    u8 sha_buf[0x20];
+    sha_quick(sha_buf, "abc", 3, SHA256_MODE);
+    CHECK(memcmp(sha_buf, sha_abc, 0x20) == 0, "SHA-256(\"abc\") is wrong");
+
+    run(false);
+    run(true);
+    return test_result("disadiff_test");
+}
@@ -0,0 +1,127 @@
+// directory index (filesys/fsdir.c), memory use and build / sort time
+// - a synthetic listing, built and sorted again and again, like on dir refreshes
+// - compared to the old fixed array, 2048 entries with a 256 byte path each
+// - checks paths survive growth and sorting, and the MAX_DIR_ENTRIES cap
+
+#include "test.h"
+#include "fsdir.h"
+
+int compDirEntry(const void* e1, const void* e2);
+
+#define N_ENTRIES   2000 // fits the old fixed array
+#define N_ROUNDS    200
+
+// the old DirEntry / DirStruct
+typedef struct {
+    char* name;
+    char path[256];
+    u64 size;
+    EntryType type;
+    u8 marked;
+    u8 p_name;
+} OldDirEntry;
+
+typedef struct {
+    u32 n_entries;
+    OldDirEntry entry[2048];
+} OldDirStruct;
+
+static int compOldDirEntry(const void* e1, const void* e2) {
+    const OldDirEntry* entry1 = (const OldDirEntry*) e1;
+    const OldDirEntry* entry2 = (const OldDirEntry*) e2;
+    if (entry1->type != entry2->type)
+        return entry1->type - entry2->type;
+    return strncasecmp(entry1->path, entry2->path, 256);
+}
+
+// deterministic, unsorted names of varying length
+static void make_path(char* path, u32 i) {
+    static const char* exts[] = { "bin", "cia", "3dsx", "firm", "gm9" };
+    snprintf(path, 256, "0:/gm9/out/%s%05lu.%s", (i % 3) ? "file_" : "a_much_longer_file_name_",
+        (unsigned long) ((i * 7919) % 100000), exts[i % countof(exts)]);
+}
+
+static u32 fill_new(DirStruct* contents, u32 n) {
+    char path[256];
+    contents->n_entries = 0;
+    for (u32 i = 0; i < n; i++) {
+        make_path(path, i);
+        DirEntry* entry = AddDirEntry(contents, path, 11);
+        if (!entry) break;
+        entry->type = (i % 5) ? T_FILE : T_DIR;
+        entry->size = i;
+    }
+    return contents->n_entries;
+}
+
+static void fill_old(OldDirStruct* contents, u32 n) {
+    contents->n_entries = 0;
+    for (u32 i = 0; (i < n) && (i < countof(contents->entry)); i++) {
+        OldDirEntry* entry = &(contents->entry[contents->n_entries++]);
+        make_path(entry->path, i);
+        entry->p_name = 11;
+        entry->name = entry->path + entry->p_name;
+        entry->type = (i % 5) ? T_FILE : T_DIR;
+        entry->size = i;
+        entry->marked = 0;
+    }
+}
+
+int main(void) {
+    DirStruct contents;
+    InitDirStruct(&contents);
+    static OldDirStruct old_contents;
+
+    // new index
+    double t0 = test_seconds();
+    for (u32 r = 0; r < N_ROUNDS; r++) {
+        fill_new(&contents, N_ENTRIES);
+        SortDirStruct(&contents);
+    }
+    double t_new = (test_seconds() - t0) / N_ROUNDS;
+    CHECK(contents.n_entries == N_ENTRIES, "%lu entries", (unsigned long) contents.n_entries);
+
+    // all entries there, sorted, with proper paths and names
+    u8* seen = calloc(N_ENTRIES, 1);
+    for (u32 i = 0; i < contents.n_entries; i++) {
+        DirEntry* entry = &(contents.entry[i]);
+        char path[256];
+        u32 idx = entry->size;
+        make_path(path, idx);
+        CHECK((idx < N_ENTRIES) && !seen[idx], "entry %lu: bad index %lu", (unsigned long) i, (unsigned long) idx);
+        if (idx < N_ENTRIES) seen[idx] = 1;
+        CHECK(strcmp(entry->path, path) == 0, "entry %lu: path %s, not %s", (unsigned long) i, entry->path, path);
+        CHECK(entry->name == entry->path + 11, "entry %lu: name not inside the path", (unsigned long) i);
+        if (i) CHECK(compDirEntry(entry - 1, entry) <= 0, "entry %lu: not sorted", (unsigned long) i);
+    }
+    free(seen);
+
+    u32 mem_new = (contents.max_entries * sizeof(DirEntry)) + contents.arena_size;
+
+    // old fixed array
+    t0 = test_seconds();
+    for (u32 r = 0; r < N_ROUNDS; r++) {
+        fill_old(&old_contents, N_ENTRIES);
+        qsort(old_contents.entry, old_contents.n_entries, sizeof(OldDirEntry), compOldDirEntry);
+        for (u32 i = 0; i < old_contents.n_entries; i++) // fix names after sorting
+            old_contents.entry[i].name = old_contents.entry[i].path + old_contents.entry[i].p_name;
+    }
+    double t_old = (test_seconds() - t0) / N_ROUNDS;
+
+    printf("%u entries, build + sort: %.3f ms (old: %.3f ms)\n", N_ENTRIES, t_new * 1e3, t_old * 1e3);
+    printf("memory: %lu bytes (old: %lu bytes, fixed)\n", (unsigned long) mem_new, (unsigned long) sizeof(OldDirStruct));
+
+    // growth is capped
+    u32 n_capped = fill_new(&contents, MAX_DIR_ENTRIES + 100);
+    CHECK(n_capped == MAX_DIR_ENTRIES, "%lu entries past the cap", (unsigned long) n_capped);
+    CHECK(!AddDirEntry(&contents, "0:/x", 3), "entry added past the cap");
+    char path[256];
+    make_path(path, MAX_DIR_ENTRIES - 1);
+    CHECK(strcmp(contents.entry[MAX_DIR_ENTRIES-1].path, path) == 0, "last entry is %s",
+        contents.entry[MAX_DIR_ENTRIES-1].path);
+    printf("%u entries (cap): %lu bytes\n", MAX_DIR_ENTRIES,
+        (unsigned long) ((contents.max_entries * sizeof(DirEntry)) + contents.arena_size));
+
+    FreeDirStruct(&contents);
+    return test_result("fsdir_bench");
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+// host stand-in for common/arm.h, for code shared between two host threads
+// - the host caches are coherent, cache maintenance is only a memory barrier
+// - "interrupts" are PXI commands run by the ARM9 thread (host/jobs_arm11.c),
+//   critical sections keep them out with a lock
+
+#include <types.h>
+
+void host_irq_lock(void);
+void host_irq_unlock(void);
+
+static inline void ARM_DSB(void) {
+	__sync_synchronize();
+}
+
+static inline u32 ARM_EnterCritical(void) {
+	host_irq_lock();
+	return 0;
+}
+
+static inline void ARM_LeaveCritical(u32 stat) {
+	(void) stat;
+	host_irq_unlock();
+}
+
+static inline void ARM_InvDC_Range(void *base, u32 len) {
+	(void) base; (void) len;
+	__sync_synchronize();
+}
+
+static inline void ARM_WbDC_Range(void *base, u32 len) {
+	(void) base; (void) len;
+	__sync_synchronize();
+}
+
+static inline void ARM_WbDC(void) {
+	__sync_synchronize();
+}
+
+static inline void ARM_WbInvDC_Range(void *base, u32 len) {
+	(void) base; (void) len;
+	__sync_synchronize();
+}
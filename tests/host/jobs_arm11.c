@@ -0,0 +1,141 @@
+// host build of the ARM11 job runner (arm11/source/system/jobs.c)
+// see jobs_host.h, the main loop below mirrors the one in arm11/source/main.c
+
+// built along with ARM9 code, but this is the ARM11 side
+#undef ARM9
+#define ARM11
+
+#include <pthread.h>
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "jobs_host.h"
+#include <pxi.h>
+
+#define I2C_readRegBuf host_i2c_readRegBuf
+#define I2C_writeRegBuf host_i2c_writeRegBuf
+#include "system/jobs.c"
+
+SystemSHMEM host_shmem;
+u8 host_i2c_regs[HOST_I2C_DEVICES][256];
+HostI2cAccess host_i2c_log[HOST_I2C_LOG_SIZE];
+volatile u32 host_i2c_log_count = 0;
+volatile u32 host_i2c_delay_ns = 0;
+volatile u32 host_kicks = 0;
+volatile u32 host_pxi_cmds = 0;
+volatile u32 host_runs = 0;
+
+static void host_i2c_access(bool write, int devId, u8 regAddr, u8 *buf, u32 size) {
+    struct timespec t0, t;
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    do clock_gettime(CLOCK_MONOTONIC, &t);
+    while (((t.tv_sec - t0.tv_sec) * 1000000000LL) + (t.tv_nsec - t0.tv_nsec) < host_i2c_delay_ns);
+
+    HostI2cAccess* access = &host_i2c_log[host_i2c_log_count++ % HOST_I2C_LOG_SIZE];
+    access->write = write;
+    access->dev = devId;
+    access->reg = regAddr;
+    access->size = size;
+    memcpy(access->data, buf, size);
+}
+
+bool host_i2c_readRegBuf(int devId, u8 regAddr, u8 *out, u32 size) {
+    if ((devId < 0) || (devId >= HOST_I2C_DEVICES) || (regAddr + size > 256)) return false;
+    memcpy(out, host_i2c_regs[devId] + regAddr, size);
+    host_i2c_access(false, devId, regAddr, out, size);
+    return true;
+}
+
+bool host_i2c_writeRegBuf(int devId, u8 regAddr, const u8 *in, u32 size) {
+    if ((devId < 0) || (devId >= HOST_I2C_DEVICES) || (regAddr + size > 256)) return false;
+    memcpy(host_i2c_regs[devId] + regAddr, in, size);
+    host_i2c_access(true, devId, regAddr, host_i2c_regs[devId] + regAddr, size);
+    return true;
+}
+
+// the mutex stands in for masked interrupts, the condition for the PXI IRQ
+static pthread_t arm11_thread;
+static pthread_mutex_t irq_lock = PTHREAD_MUTEX_INITIALIZER;
+
+void host_irq_lock(void) {
+    pthread_mutex_lock(&irq_lock);
+}
+
+void host_irq_unlock(void) {
+    pthread_mutex_unlock(&irq_lock);
+}
+static pthread_cond_t irq = PTHREAD_COND_INITIALIZER;
+static u32 irq_pending = 0;
+static bool arm11_stop = false;
+
+static void* host_arm11_main(void* arg) {
+    SystemJobQueue* queue = &host_shmem.jobQueue;
+    (void) arg;
+
+    for (;;) {
+        pthread_mutex_lock(&irq_lock);
+        if (!JOB_Pending(queue) && !irq_pending && !arm11_stop)
+            pthread_cond_wait(&irq, &irq_lock); // WFI
+        irq_pending = 0;
+        bool stop = arm11_stop;
+        pthread_mutex_unlock(&irq_lock);
+        if (stop) break;
+
+        JOB_RunQueue(queue);
+        host_runs++;
+    }
+    return NULL;
+}
+
+// PXI_RX_Handler() from arm11/source/main.c, the commands the job tests need
+u32 host_arm11_pxi(u32 cmd, const u32 *args, u32 argc) {
+    u32 ret;
+
+    pthread_mutex_lock(&irq_lock);
+    host_pxi_cmds++;
+    switch (cmd) {
+        case PXI_I2C_READ:
+        case PXI_I2C_WRITE:
+        {
+            u32 devId = (args[0] & 0xff);
+            u32 regAddr = (args[0] >> 8) & 0xff;
+            u32 size = (args[0] >> 16) % I2C_SHARED_BUFSZ;
+            if (argc != 1) abort();
+            if (cmd == PXI_I2C_READ) ret = host_i2c_readRegBuf(devId, regAddr, host_shmem.i2cBuffer, size);
+            else ret = host_i2c_writeRegBuf(devId, regAddr, host_shmem.i2cBuffer, size);
+            break;
+        }
+
+        case PXI_JOB_NOTIFY:
+            // jobs are run from the main loop, this only wakes it up
+            irq_pending = 1;
+            host_kicks++;
+            pthread_cond_signal(&irq);
+            ret = 0;
+            break;
+
+        default:
+            printf("unexpected PXI command %lu\n", (unsigned long) cmd);
+            abort();
+    }
+    pthread_mutex_unlock(&irq_lock);
+
+    return ret;
+}
+
+void host_arm11_start(void) {
+    // shared memory isn't initialized, start with an empty job queue
+    host_shmem.jobQueue.head = 0;
+    host_shmem.jobQueue.tail = 0;
+    arm11_stop = false;
+    pthread_create(&arm11_thread, NULL, host_arm11_main, NULL);
+}
+
+void host_arm11_stop(void) {
+    pthread_mutex_lock(&irq_lock);
+    arm11_stop = true;
+    pthread_cond_signal(&irq);
+    pthread_mutex_unlock(&irq_lock);
+    pthread_join(arm11_thread, NULL);
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+// host side ARM9 <-> ARM11 job queue (system/jobs.c on both sides)
+// - host_shmem is the shared memory, the ARM9 side finds it via shmemGlobalBase
+// - a thread runs the ARM11 main loop, it sleeps until PXI_JOB_NOTIFY comes in
+// - PXI commands are a loopback, the ARM11 handler runs right on the ARM9 thread
+// - the ARM11 sees a fake I2C bus, every register access is logged and can be made slow
+
+#include <types.h>
+#include <shmem.h>
+
+#define HOST_I2C_DEVICES    32 // device ids past this don't ack
+#define HOST_I2C_LOG_SIZE   (1 << 16)
+
+typedef struct {
+    u8 write;
+    u8 dev;
+    u8 reg;
+    u8 size;
+    u8 data[JOB_DATA_SIZE];
+} HostI2cAccess;
+
+extern SystemSHMEM host_shmem;
+extern u8 host_i2c_regs[HOST_I2C_DEVICES][256];
+extern HostI2cAccess host_i2c_log[HOST_I2C_LOG_SIZE];
+extern volatile u32 host_i2c_log_count;
+extern volatile u32 host_i2c_delay_ns; // busy time per bus access, the real bus is slow
+extern volatile u32 host_kicks;
+extern volatile u32 host_pxi_cmds;
+extern volatile u32 host_runs;
+
+void host_arm11_start(void);
+void host_arm11_stop(void);
+u32 host_arm11_pxi(u32 cmd, const u32 *args, u32 argc);
@@ -0,0 +1,147 @@
+// host build of utils/scripting.c
+// - scripts come from memory (host_reset), not from the SD card
+// - 'echo' and error prompts go to a text log (host_log)
+// - a fake directory T:/dir with host_n_files files for 'for' loops
+// - malloc can be made to fail at a given call (host_fail_malloc_at)
+
+#include <stdarg.h>
+#include "common.h"
+#include "unittype.h"
+#include "scripting_host.h"
+
+// no hardware registers on the host
+#undef IS_O3DS
+#undef IS_DEVKIT
+#undef IS_UNLOCKED
+#define IS_O3DS     true
+#define IS_DEVKIT   false
+#define IS_UNLOCKED false
+
+static u32 host_malloc_calls = 0;
+u32 host_fail_malloc_at = 0;
+
+static void* host_malloc(size_t size) {
+    if (host_fail_malloc_at && (++host_malloc_calls == host_fail_malloc_at)) return NULL;
+    return malloc(size);
+}
+
+static void* host_realloc(void* ptr, size_t size) {
+    if (host_fail_malloc_at && (++host_malloc_calls == host_fail_malloc_at)) return NULL;
+    return realloc(ptr, size);
+}
+
+#define malloc host_malloc
+#define realloc host_realloc
+#include "scripting.c"
+#undef malloc
+#undef realloc
+
+char host_log[HOST_LOG_SIZE];
+u32 host_n_files = 0;
+static const char* host_script = NULL;
+
+void host_reset(const char* script) {
+    host_script = script;
+    *host_log = '\0';
+    host_malloc_calls = 0;
+}
+
+static void host_logf(const char* format, va_list va) {
+    size_t len = strnlen(host_log, HOST_LOG_SIZE);
+    vsnprintf(host_log + len, HOST_LOG_SIZE - len, format, va);
+    len = strnlen(host_log, HOST_LOG_SIZE);
+    if (len < HOST_LOG_SIZE - 1) strcat(host_log, "|");
+}
+
+bool ShowPrompt(bool ask, const char *format, ...) {
+    (void) ask;
+    va_list va;
+    va_start(va, format);
+    host_logf(format, va);
+    va_end(va);
+    return false;
+}
+
+void ShowString(const char *format, ...) {
+    (void) format;
+}
+
+void TruncateString(char* dest, const char* orig, int nsize, int tpos) {
+    (void) tpos;
+    snprintf(dest, nsize + 1, "%s", orig);
+}
+
+size_t FileGetData(const char* path, void* data, size_t size, size_t foffset) {
+    if (!host_script || (strncmp(path, HOST_SCRIPT_PATH, 256) != 0)) return 0;
+    size_t len = strlen(host_script);
+    if (foffset >= len) return 0;
+    len = min(len - foffset, size);
+    memcpy(data, host_script + foffset, len);
+    return len;
+}
+
+bool get_dstime(DsTime* dstime) {
+    memset(dstime, 0, sizeof(DsTime));
+    return true;
+}
+
+u32 GetEmuNandBase(void) {
+    return 0;
+}
+
+const char* const g_regionNamesShort[SMDH_NUM_REGIONS] = { "JPN", "USA", "EUR", "AUS", "CHN", "KOR", "TWN" };
+
+// fake directory: T:/dir holds host_n_files files, named f00000 ...
+FRESULT fvx_opendir(DIR* dp, const TCHAR* path) {
+    if (strncmp(path, "T:/dir", 256) != 0) return FR_NO_PATH;
+    dp->dptr = 0;
+    return FR_OK;
+}
+
+FRESULT fvx_closedir(DIR* dp) {
+    (void) dp;
+    return FR_OK;
+}
+
+FRESULT fvx_preaddir(DIR* dp, FILINFO* fno, const TCHAR* pattern) {
+    (void) pattern;
+    memset(fno, 0, sizeof(FILINFO));
+    if (dp->dptr < host_n_files) snprintf(fno->fname, sizeof(fno->fname), "f%05lu", (unsigned long) dp->dptr++);
+    return FR_OK;
+}
+
+// line index control for the cross checks
+static Gm9ScriptLine* host_lines = NULL;
+
+bool host_index_script(char* script, u32 size) {
+    script_buffer = script;
+    script_lines = NULL;
+    if (!index_lines(script, script + size)) return false;
+    host_lines = script_lines;
+    return true;
+}
+
+void host_drop_index(void) {
+    script_lines = NULL;
+}
+
+void host_restore_index(void) {
+    script_lines = host_lines;
+}
+
+void host_free_index(void) {
+    free(host_lines);
+    host_lines = script_lines = NULL;
+    script_buffer = NULL;
+}
+
+bool host_setup_vars(void) {
+    var_table = (Gm9ScriptVar**) calloc(_VAR_HASH_SIZE, sizeof(Gm9ScriptVar*));
+    return var_table && init_vars(HOST_SCRIPT_PATH);
+}
+
+void host_free_vars(void) {
+    if (var_table) free_vars();
+    free(var_table);
+    var_table = NULL;
+}
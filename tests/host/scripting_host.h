@@ -0,0 +1,27 @@
+#pragma once
+
+#include "common.h"
+
+#define HOST_LOG_SIZE       (64 * 1024)
+#define HOST_SCRIPT_PATH    "T:/test.gm9"
+
+extern char host_log[HOST_LOG_SIZE]; // 'echo' output and error prompts, '|' separated
+extern u32 host_n_files; // # of files in the fake dir T:/dir
+extern u32 host_fail_malloc_at; // nth malloc() / realloc() after host_reset() fails, 0 -> never
+
+void host_reset(const char* script);
+
+bool ExecuteGM9Script(const char* path_script);
+char* set_var(const char* name, const char* content);
+char* get_var(const char* name, char** endptr);
+bool host_setup_vars(void); // variables outside of ExecuteGM9Script()
+void host_free_vars(void);
+
+// control flow helpers from scripting.c, for cross checks
+char* skip_block(char* ptr, bool ignore_else, bool stop_after_end);
+char* find_next(char* ptr);
+char* find_label(const char* label, const char* last_found);
+bool host_index_script(char* script, u32 size); // false if the line index isn't set up
+void host_drop_index(void); // back to plain scanning
+void host_restore_index(void);
+void host_free_index(void);
@@ -0,0 +1,84 @@
+// link time stand-ins for firmware functions the host tests never reach
+// they are weak, so a test can provide a working fake of its own instead
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#define UNUSED(name) \
+    __attribute__((weak)) void name(void) { \
+        fprintf(stderr, "unexpected call to %s()\n", #name); \
+        abort(); \
+    }
+
+// scripting.c, disadiff.c
+UNUSED(ApplyBPMPatch)
+UNUSED(ApplyBPSPatch)
+UNUSED(ApplyIPSPatch)
+UNUSED(AutoEmuNandBase)
+UNUSED(BootFirm)
+UNUSED(BuildCiaFromGameFile)
+UNUSED(BuildSeedInfo)
+UNUSED(BuildTitleKeyInfo)
+UNUSED(CheckButton)
+UNUSED(CheckDirWritePermissions)
+UNUSED(CheckSDMountState)
+UNUSED(CheckWritePermissions)
+UNUSED(ClearScreen)
+UNUSED(ClearScreenF)
+UNUSED(CompressCode)
+UNUSED(CryptAesKeyDb)
+UNUSED(CryptGameFile)
+UNUSED(DeinitExtFS)
+UNUSED(DeinitSDCardFS)
+UNUSED(DismountDriveType)
+UNUSED(DrawBitmap)
+UNUSED(DrawQrCode)
+UNUSED(DrawString)
+UNUSED(DrawStringCenter)
+UNUSED(DrawStringF)
+UNUSED(ExtractCodeFromCxiFile)
+UNUSED(FileCreateDummy)
+UNUSED(FileGetSha256)
+UNUSED(FileGetSize)
+UNUSED(FileInjectFile)
+UNUSED(FileSelector)
+UNUSED(FileSetByte)
+UNUSED(FileSetData)
+UNUSED(GetEmuNandBase)
+UNUSED(GetFontHeight)
+UNUSED(GetFontWidth)
+UNUSED(IdentifyFileType)
+UNUSED(InitExtFS)
+UNUSED(InitImgFS)
+UNUSED(InitSDCardFS)
+UNUSED(InputWait)
+UNUSED(InstallGameFile)
+UNUSED(PNG_Decompress)
+UNUSED(PXI_Barrier)
+UNUSED(PXI_DoCMD)
+UNUSED(PathDelete)
+UNUSED(PathMoveCopy)
+UNUSED(PowerOff)
+UNUSED(Reboot)
+UNUSED(RecursiveFixFileCmac)
+UNUSED(ShowGameFileTitleInfoF)
+UNUSED(ShowHotkeyPrompt)
+UNUSED(ShowKeyboard)
+UNUSED(ShowNumberPrompt)
+UNUSED(ShowSelectPrompt)
+UNUSED(ShowStringPrompt)
+UNUSED(StringToButton)
+UNUSED(TouchIsCalibrated)
+UNUSED(ValidateFirm)
+UNUSED(ValidateNandDump)
+UNUSED(VerifyGameFile)
+UNUSED(fvx_findnopath)
+UNUSED(fvx_findpath)
+UNUSED(fvx_lseek)
+UNUSED(fvx_read)
+UNUSED(fvx_rmkdir)
+UNUSED(fvx_stat)
+UNUSED(fvx_unlink)
+UNUSED(fvx_write)
+UNUSED(qrcodegen_encodeText)
+UNUSED(sha_quick)
@@ -0,0 +1,119 @@
+// I2C from the ARM9 (system/i2c.c, common/power.c), over a PXI loopback
+// - synchronous reads / writes are one PXI command each, through the shared buffer
+// - queued reads go through the job ring and run on the host ARM11 thread
+// - both have to see the same registers, GetPowerStatus() has to agree with
+//   GetBatteryPercent() and IsCharging(), for fewer PXI commands
+
+#include <unistd.h>
+#include "test.h"
+#include "i2c.h"
+#include "power.h"
+#include "pxi.h"
+#include "host/jobs_host.h"
+
+#define N_ROUNDS    2000
+#define BUS_DELAY   50000 // ns per access, roughly one byte on the MCU bus
+
+SystemSHMEM *shmemGlobalBase = &host_shmem;
+
+u32 PXI_DoCMD(u32 cmd, const u32 *args, u32 argc) {
+    return host_arm11_pxi(cmd, args, argc);
+}
+
+static void check_sync(unsigned int* seed) {
+    u8 data[16], back[16];
+
+    for (u32 i = 0; i < N_ROUNDS; i++) {
+        u8 dev = test_rand(seed) % HOST_I2C_DEVICES;
+        u8 size = 1 + (test_rand(seed) % sizeof(data));
+        u8 reg = test_rand(seed) % (256 - size + 1);
+        for (u32 b = 0; b < size; b++)
+            data[b] = test_rand(seed);
+
+        u32 cmds = host_pxi_cmds;
+        CHECK(I2C_writeRegBuf(dev, reg, data, size), "write %lu failed", (unsigned long) i);
+        CHECK(memcmp(host_i2c_regs[dev] + reg, data, size) == 0, "write %lu: wrong data on the bus", (unsigned long) i);
+        CHECK(I2C_readRegBuf(dev, reg, back, size), "read %lu failed", (unsigned long) i);
+        CHECK(memcmp(back, data, size) == 0, "read %lu: wrong data", (unsigned long) i);
+        CHECK(host_pxi_cmds == cmds + 2, "%lu PXI commands", (unsigned long) (host_pxi_cmds - cmds));
+    }
+
+    CHECK(!I2C_readRegBuf(HOST_I2C_DEVICES, 0, back, 1), "read from a missing device");
+    CHECK(!I2C_writeReg(HOST_I2C_DEVICES, 0, 0), "write to a missing device");
+}
+
+// a ring's worth of queued reads at once, against synchronous reads
+static void check_queued(unsigned int* seed) {
+    for (u32 i = 0; i < 256; i++)
+        host_i2c_regs[I2C_DEV_MCU][i] = test_rand(seed);
+
+    for (u32 reg = 0; reg < 256; reg += JOB_QUEUE_SLOTS) {
+        u32 ticket[JOB_QUEUE_SLOTS];
+        for (u32 j = 0; j < JOB_QUEUE_SLOTS; j++) {
+            ticket[j] = I2C_queueReadRegBuf(I2C_DEV_MCU, reg + j, 1);
+            CHECK(ticket[j], "read of 0x%02lX not queued", (unsigned long) (reg + j));
+        }
+        for (u32 j = 0; j < JOB_QUEUE_SLOTS; j++) {
+            u8 queued = 0, sync = 0;
+            CHECK(I2C_waitReadRegBuf(ticket[j], &queued, 1), "queued read of 0x%02lX failed", (unsigned long) (reg + j));
+            CHECK(I2C_readRegBuf(I2C_DEV_MCU, reg + j, &sync, 1), "read of 0x%02lX failed", (unsigned long) (reg + j));
+            CHECK(queued == sync, "register 0x%02lX: queued read 0x%02X, synchronous 0x%02X",
+                (unsigned long) (reg + j), queued, sync);
+        }
+    }
+
+    u8 data[JOB_DATA_SIZE + 1];
+    CHECK(!I2C_waitReadRegBuf(0, data, 1), "wait on ticket 0 succeeded");
+    CHECK(!I2C_waitReadRegBuf(I2C_queueReadRegBuf(I2C_DEV_MCU, 0, sizeof(data)), data, sizeof(data)),
+        "queued read past the inline data");
+}
+
+static void check_power(unsigned int* seed) {
+    u32 cmds_sync = 0, cmds_batch = 0;
+    double t_sync = 0, t_batch = 0;
+
+    host_i2c_delay_ns = BUS_DELAY;
+    for (u32 i = 0; i < N_ROUNDS / 10; i++) {
+        host_i2c_regs[I2C_DEV_MCU][0x0B] = test_rand(seed) % 101;
+        host_i2c_regs[I2C_DEV_MCU][0x0F] = test_rand(seed);
+
+        u32 cmds = host_pxi_cmds;
+        double t0 = test_seconds();
+        u32 battery_s = GetBatteryPercent();
+        bool charging_s = IsCharging();
+        t_sync += test_seconds() - t0;
+        cmds_sync += host_pxi_cmds - cmds;
+
+        u32 battery = 0;
+        bool charging = false;
+        cmds = host_pxi_cmds;
+        t0 = test_seconds();
+        GetPowerStatus(&battery, &charging);
+        t_batch += test_seconds() - t0;
+        cmds_batch += host_pxi_cmds - cmds;
+
+        CHECK(battery == battery_s, "battery %lu%%, not %lu%%", (unsigned long) battery, (unsigned long) battery_s);
+        CHECK(charging == charging_s, "charging %d, not %d", charging, charging_s);
+    }
+    host_i2c_delay_ns = 0;
+
+    // one doorbell for both reads, the ARM9 doesn't wait on the bus in between
+    CHECK(cmds_batch == N_ROUNDS / 10, "%lu PXI commands for %u batched status reads",
+        (unsigned long) cmds_batch, N_ROUNDS / 10);
+    printf("power status: %.1f us, %.1f PXI commands separately, %.1f us, %.1f PXI commands batched\n",
+        t_sync * 1e6 / (N_ROUNDS / 10), (double) cmds_sync / (N_ROUNDS / 10),
+        t_batch * 1e6 / (N_ROUNDS / 10), (double) cmds_batch / (N_ROUNDS / 10));
+}
+
+int main(void) {
+    unsigned int seed = 1;
+    alarm(60);
+
+    host_arm11_start();
+    check_sync(&seed);
+    check_queued(&seed);
+    check_power(&seed);
+    host_arm11_stop();
+
+    return test_result("i2c_test");
+}
@@ -0,0 +1,165 @@
+// ARM9 -> ARM11 job queue (system/jobs.c on both sides), run by two host threads
+// - the ARM9 side is the test itself, the ARM11 main loop is a second thread
+// - jobs have to run exactly once and in order, also when batches overrun the ring
+// - results and inline data have to come back to the right ticket
+// - the doorbell (PXI_JOB_NOTIFY) only rings for new jobs, and nothing is lost
+//   if it doesn't (a lost wakeup hangs the test, the alarm below catches that)
+
+#include <string.h>
+#include <unistd.h>
+#include "test.h"
+#include "jobs.h"
+#include "pxi.h"
+#include "host/jobs_host.h"
+
+#define N_WRITES    20000
+#define N_READS     2000
+#define N_ROUNDS    20000
+
+SystemSHMEM *shmemGlobalBase = NULL;
+
+u32 PXI_DoCMD(u32 cmd, const u32 *args, u32 argc) {
+    return host_arm11_pxi(cmd, args, argc);
+}
+
+static void check_unavailable(void) {
+    shmemGlobalBase = NULL;
+    CHECK(!JOB_Available(), "jobs available without shared memory");
+    CHECK(JOB_Queue(JOB_NOP, 0, 0, 0, 0, NULL, 0) == 0, "job queued without shared memory");
+    CHECK(JOB_Done(1), "job pending without shared memory");
+    CHECK(JOB_Wait(1) == 0, "job result without shared memory");
+    shmemGlobalBase = &host_shmem;
+}
+
+static void check_round_trips(void) {
+    u32 head = host_shmem.jobQueue.head;
+    for (u32 i = 1; i <= 100; i++) {
+        u32 ticket = JOB_Submit(JOB_NOP, 0, 0, 0, 0);
+        CHECK(ticket == head + i, "ticket %lu, expected %lu", (unsigned long) ticket, (unsigned long) (head + i));
+        CHECK(JOB_Wait(ticket) == 0, "NOP returned something");
+        CHECK(JOB_Done(ticket), "NOP %lu not done after waiting", (unsigned long) ticket);
+    }
+    u32 ticket = JOB_Submit(0x1234, 0, 0, 0, 0);
+    CHECK(JOB_Wait(ticket) == 0xFFFFFFFF, "unknown job type accepted");
+    u8 data[JOB_DATA_SIZE + 1] = { 0 };
+    CHECK(JOB_Queue(JOB_I2C_WRITE, 0, 0, 0, sizeof(data), data, sizeof(data)) == 0, "oversized inline data queued");
+    ticket = JOB_Submit(JOB_I2C_READ, 0, 0, 0, sizeof(data));
+    CHECK(JOB_Wait(ticket) == 0, "oversized read accepted");
+}
+
+// random batches of I2C writes, up to 2.5 times the ring size before a kick
+static void check_ordering(unsigned int* seed) {
+    static HostI2cAccess expected[N_WRITES];
+    u32 log_start = host_i2c_log_count;
+    u32 last = 0;
+
+    for (u32 i = 0; i < N_WRITES;) {
+        u32 batch = 1 + (test_rand(seed) % (JOB_QUEUE_SLOTS * 5 / 2));
+        for (; batch && (i < N_WRITES); batch--, i++) {
+            HostI2cAccess* access = expected + i;
+            access->write = 1;
+            access->dev = test_rand(seed) % HOST_I2C_DEVICES;
+            access->size = 1 + (test_rand(seed) % JOB_DATA_SIZE);
+            access->reg = test_rand(seed) % (256 - access->size + 1);
+            for (u32 b = 0; b < access->size; b++)
+                access->data[b] = test_rand(seed);
+            u32 ticket = JOB_Queue(JOB_I2C_WRITE, 0, access->dev, access->reg, access->size,
+                access->data, access->size);
+            CHECK(ticket == last + 1 || !last, "ticket %lu after %lu", (unsigned long) ticket, (unsigned long) last);
+            last = ticket;
+        }
+        if (test_rand(seed) % 4) JOB_Kick();
+        else CHECK(JOB_Wait(last) == 1, "write %lu failed", (unsigned long) i);
+    }
+    CHECK(JOB_Wait(last) == 1, "last write failed");
+
+    u32 n_log = host_i2c_log_count - log_start;
+    CHECK(n_log == N_WRITES, "%lu writes ran, expected %u", (unsigned long) n_log, N_WRITES);
+    for (u32 i = 0; (i < n_log) && (i < N_WRITES); i++) {
+        HostI2cAccess* exp = expected + i;
+        HostI2cAccess* log = host_i2c_log + ((log_start + i) % HOST_I2C_LOG_SIZE);
+        if ((log->write != exp->write) || (log->dev != exp->dev) || (log->reg != exp->reg) ||
+            (log->size != exp->size) || (memcmp(log->data, exp->data, exp->size) != 0)) {
+            CHECK(false, "write %lu ran out of order", (unsigned long) i);
+            break;
+        }
+    }
+}
+
+// a full ring of reads, waited on in order, the oldest result is still there
+// - on a slow bus, the ARM9 is waiting while the ARM11 still works on the job
+static void check_results(unsigned int* seed) {
+    u32 ticket[JOB_QUEUE_SLOTS];
+    u8 dev[JOB_QUEUE_SLOTS], reg[JOB_QUEUE_SLOTS], size[JOB_QUEUE_SLOTS];
+    host_i2c_delay_ns = 20000;
+
+    for (u32 i = 0; i < N_READS; i += JOB_QUEUE_SLOTS) {
+        for (u32 j = 0; j < JOB_QUEUE_SLOTS; j++) {
+            dev[j] = test_rand(seed) % (HOST_I2C_DEVICES + 2); // some don't exist
+            size[j] = 1 + (test_rand(seed) % JOB_DATA_SIZE);
+            reg[j] = test_rand(seed) % (256 - size[j] + 1);
+            ticket[j] = JOB_Queue(JOB_I2C_READ, 0, dev[j], reg[j], size[j], NULL, 0);
+        }
+        for (u32 j = 0; j < JOB_QUEUE_SLOTS; j++) {
+            u8 data[JOB_DATA_SIZE];
+            bool exists = dev[j] < HOST_I2C_DEVICES;
+            u32 res = JOB_WaitData(ticket[j], data, size[j]);
+            CHECK(res == exists, "read %lu returned %lu", (unsigned long) (i + j), (unsigned long) res);
+            if (exists) CHECK(memcmp(data, host_i2c_regs[dev[j]] + reg[j], size[j]) == 0,
+                "read %lu: wrong data", (unsigned long) (i + j));
+        }
+    }
+    host_i2c_delay_ns = 0;
+}
+
+static void check_doorbell(void) {
+    JOB_Wait(JOB_Submit(JOB_NOP, 0, 0, 0, 0));
+
+    u32 kicks = host_kicks;
+    u32 last = 0;
+    for (u32 i = 0; i < JOB_QUEUE_SLOTS / 2; i++)
+        last = JOB_Queue(JOB_NOP, 0, 0, 0, 0, NULL, 0);
+    CHECK(host_kicks == kicks, "kicked while queueing");
+    JOB_Kick();
+    JOB_Kick();
+    JOB_Wait(last);
+    CHECK(host_kicks == kicks + 1, "%lu kicks for one batch", (unsigned long) (host_kicks - kicks));
+    CHECK(host_shmem.jobQueue.tail == host_shmem.jobQueue.head, "jobs left in the queue");
+}
+
+static void benchmark(void) {
+    double t0 = test_seconds();
+    for (u32 i = 0; i < N_ROUNDS; i++)
+        JOB_Wait(JOB_Submit(JOB_NOP, 0, 0, 0, 0));
+    double t_single = (test_seconds() - t0) / N_ROUNDS;
+
+    u32 kicks = host_kicks;
+    t0 = test_seconds();
+    for (u32 i = 0; i < N_ROUNDS; i += JOB_QUEUE_SLOTS) {
+        u32 last = 0;
+        for (u32 j = 0; j < JOB_QUEUE_SLOTS; j++)
+            last = JOB_Queue(JOB_NOP, 0, 0, 0, 0, NULL, 0);
+        JOB_Wait(last);
+    }
+    double t_batch = (test_seconds() - t0) / N_ROUNDS;
+
+    printf("per job: %.2f us submitted one by one, %.2f us in batches of %u (%lu kicks for %u jobs)\n",
+        t_single * 1e6, t_batch * 1e6, JOB_QUEUE_SLOTS, (unsigned long) (host_kicks - kicks), N_ROUNDS);
+}
+
+int main(void) {
+    unsigned int seed = 1;
+    alarm(60);
+
+    check_unavailable();
+    host_arm11_start();
+    check_round_trips();
+    check_ordering(&seed);
+    check_results(&seed);
+    check_doorbell();
+    benchmark();
+    host_arm11_stop();
+
+    printf("%lu kicks, %lu queue runs\n", (unsigned long) host_kicks, (unsigned long) host_runs);
+    return test_result("jobs_test");
+}
@@ -0,0 +1,71 @@
+// interpreter micro-benchmark for the script variable store (utils/scripting.c)
+// - a 'for' loop over a big directory, expanding variables on every iteration
+// - plain get_var() calls with a few hundred variables defined
+// N_VARS stays below 256, the limit of the old flat variable buffer, so numbers compare
+
+#include "test.h"
+#include "host/scripting_host.h"
+
+#define N_FILES     20000
+#define N_VARS      200
+#define N_LOOKUPS   2000000
+
+static char* build_script(void) {
+    char* script = malloc(64 * 1024);
+    char* ptr = script;
+    for (u32 i = 0; i < N_VARS; i++)
+        ptr += sprintf(ptr, "set V%lu \"value %lu\"\n", (unsigned long) i, (unsigned long) i);
+    ptr += sprintf(ptr,
+        "set COUNT \"\"\n"
+        "for T:/dir *\n"
+        "    set LAST \"$[FORPATH]\"\n"
+        "    set MIX \"$[V0]-$[V150]-$[V199]-$[GM9OUT]\"\n"
+        "    if chk \"$[MIX]\" \"value 0-value 150-value 199-0:/gm9/out\"\n"
+        "        set COUNT \"$[COUNT]x\"\n"
+        "        set COUNT \"\"\n"
+        "    end\n"
+        "next\n"
+        "echo \"$[LAST]\"\n");
+    return script;
+}
+
+int main(void) {
+    char* script = build_script();
+
+    // full interpreter run
+    host_n_files = N_FILES;
+    host_reset(script);
+    double t0 = test_seconds();
+    bool ok = ExecuteGM9Script(HOST_SCRIPT_PATH);
+    double t_run = test_seconds() - t0;
+    CHECK(ok, "script failed: %s", host_log);
+    CHECK(strcmp(host_log, "T:/dir/f19999|") == 0, "unexpected output: %s", host_log);
+
+    printf("for loop: %u iterations in %.3fs (%.2f us / iteration, %u vars)\n",
+        N_FILES, t_run, (t_run * 1e6) / N_FILES, N_VARS);
+
+    // plain lookups, ExecuteGM9Script() frees its variables on exit so set up new ones
+    CHECK(host_setup_vars(), "can't set up variables");
+    static char names[N_VARS][16];
+    for (u32 i = 0; i < N_VARS; i++) {
+        char content[32];
+        snprintf(names[i], 16, "V%lu", (unsigned long) i);
+        snprintf(content, sizeof(content), "value %lu", (unsigned long) i);
+        set_var(names[i], content);
+    }
+
+    unsigned int seed = 1;
+    u32 hits = 0;
+    t0 = test_seconds();
+    for (u32 i = 0; i < N_LOOKUPS; i++) {
+        if (*get_var(names[test_rand(&seed) % N_VARS], NULL)) hits++;
+    }
+    double t_get = test_seconds() - t0;
+    CHECK(hits == N_LOOKUPS, "%lu of %u lookups failed", (unsigned long) (N_LOOKUPS - hits), N_LOOKUPS);
+    printf("get_var: %u lookups in %.3fs (%.1f ns / lookup, %u vars)\n",
+        N_LOOKUPS, t_get, (t_get * 1e9) / N_LOOKUPS, N_VARS);
+
+    host_free_vars();
+    free(script);
+    return test_result("scripting_bench");
+}
@@ -0,0 +1,226 @@
+// control flow semantics of the script interpreter (utils/scripting.c)
+// - the memoized skip_block() / find_next() / find_label() against plain scanning,
+//   at every line of the scripts given on the command line
+// - small scripts run through ExecuteGM9Script(), with and without the line index
+
+#include "test.h"
+#include "host/scripting_host.h"
+
+typedef struct {
+    const char* name;
+    u32 n_files; // files in T:/dir
+    const char* script;
+    bool result;
+    const char* log;
+} ScriptCase;
+
+static const ScriptCase cases[] = {
+    { "if / elif / else", 0,
+        "set A \"1\"\n"
+        "if chk $[A] \"2\"\n"
+        "    echo \"if\"\n"
+        "elif chk $[A] \"1\"\n"
+        "    echo \"elif\"\n"
+        "else\n"
+        "    echo \"else\"\n"
+        "end\n",
+        true, "elif|" },
+    { "nested if", 0,
+        "if chk \"a\" \"b\"\n"
+        "    if chk \"a\" \"a\"\n"
+        "        echo \"x\"\n"
+        "    else\n"
+        "        echo \"y\"\n"
+        "    end\n"
+        "    echo \"z\"\n"
+        "else\n"
+        "    if not chk \"a\" \"b\"\n"
+        "        echo \"nested\"\n"
+        "    end\n"
+        "end\n"
+        "echo \"done\"\n",
+        true, "nested|done|" },
+    { "goto loop", 0,
+        "set N \"\"\n"
+        "@loop\n"
+        "set N \"$[N]x\"\n"
+        "if chk \"$[N]\" \"xxx\"\n"
+        "    goto done\n"
+        "end\n"
+        "goto loop\n"
+        "@done\n"
+        "echo \"$[N]\"\n",
+        true, "xxx|" },
+    { "goto wildcard", 0,
+        "goto la*\n"
+        "@other\n"
+        "echo \"other\"\n"
+        "@lab1\n"
+        "echo \"lab1\"\n",
+        true, "lab1|" },
+    { "labels inside if blocks can't be reached", 0,
+        "goto hidden\n"
+        "if chk \"a\" \"b\"\n"
+        "@hidden\n"
+        "end\n",
+        false, "T:/test.gm9\nline 1: label not found\ngoto hidden|" },
+    { "line numbers after a jump", 0,
+        "set A \"1\"\n"
+        "@again\n"
+        "if chk \"$[A]\" \"2\"\n"
+        "    goto nowhere\n"
+        "end\n"
+        "set A \"2\"\n"
+        "goto again\n",
+        false, "T:/test.gm9\nline 4: label not found\ngoto nowhere|" },
+    { "for / next", 3,
+        "set L \"\"\n"
+        "for T:/dir *\n"
+        "    if chk \"$[FORPATH]\" \"T:/dir/f00001\"\n"
+        "        set L \"$[L]-one\"\n"
+        "    else\n"
+        "        set L \"$[L]-$[FORPATH]\"\n"
+        "    end\n"
+        "next\n"
+        "echo \"$[L]\"\n",
+        true, "-T:/dir/f00000-one-T:/dir/f00002|" },
+    { "for over an empty dir", 0,
+        "for T:/dir *\n"
+        "    echo \"never\"\n"
+        "next\n"
+        "echo \"after\"\n",
+        true, "after|" },
+    { "unclosed if", 0,
+        "if chk \"a\" \"b\"\n"
+        "    echo \"x\"\n",
+        false, "T:/test.gm9\nline 1: unclosed conditional\nif chk \"a\" \"b\"|" },
+    { "for without next", 1,
+        "echo \"start\"\n"
+        "for T:/dir *\n"
+        "    echo \"x\"\n",
+        false, "start|T:/test.gm9\nline 2: 'for' without 'next'\nfor T:/dir *|" },
+};
+
+static char* load_file(const char* path, u32* size) {
+    FILE* fp = fopen(path, "rb");
+    if (!fp) return NULL;
+    fseek(fp, 0, SEEK_END);
+    long len = ftell(fp);
+    fseek(fp, 0, SEEK_SET);
+    // two terminators, the scanners may look one byte past the last line
+    char* data = calloc(len + 2, 1);
+    if (data && (fread(data, 1, len, fp) != (size_t) len)) {
+        free(data);
+        data = NULL;
+    }
+    fclose(fp);
+    *size = len;
+    return data;
+}
+
+static u32 check_labels(char* script, u32 size, const char* label) {
+    u32 checks = 0;
+    const char* plain = NULL;
+    const char* indexed = NULL;
+    do {
+        host_drop_index();
+        plain = find_label(label, plain);
+        host_restore_index();
+        indexed = find_label(label, indexed);
+        CHECK(plain == indexed, "find_label(\"%s\") mismatch (%ld vs %ld)", label,
+            plain ? (long) (plain - script) : -1L, indexed ? (long) (indexed - script) : -1L);
+        checks++;
+    } while (plain && (plain == indexed) && (plain < script + size));
+    return checks;
+}
+
+static void cross_check(const char* path) {
+    u32 size = 0;
+    char* script = load_file(path, &size);
+    CHECK(script, "can't read %s", path);
+    if (!script) return;
+    CHECK(host_index_script(script, size), "can't index %s", path);
+
+    u32 checks = 0;
+    for (u32 pass = 0; pass < 2; pass++) { // second pass is served from the memo
+        for (char* ptr = script; ptr < script + size;) {
+            for (u32 mode = 0; mode < 4; mode++) {
+                bool ignore_else = mode & 1;
+                bool stop_after_end = mode & 2;
+                host_drop_index();
+                char* plain = skip_block(ptr, ignore_else, stop_after_end);
+                host_restore_index();
+                char* indexed = skip_block(ptr, ignore_else, stop_after_end);
+                CHECK(plain == indexed, "%s +%ld: skip_block(%d, %d) mismatch", path,
+                    (long) (ptr - script), ignore_else, stop_after_end);
+                checks++;
+            }
+            host_drop_index();
+            char* plain = find_next(ptr);
+            host_restore_index();
+            CHECK(plain == find_next(ptr), "%s +%ld: find_next() mismatch", path, (long) (ptr - script));
+            checks++;
+
+            char* line_end = strchr(ptr, '\n');
+            if (!line_end) break;
+            ptr = line_end + 1;
+        }
+    }
+
+    // every label in the script, in full and as wildcard of its first char
+    for (char* ptr = script; ptr < script + size;) {
+        char* str = ptr;
+        for (; (*str == ' ') || (*str == '\t'); str++);
+        if (*str++ == '@') {
+            char label[64];
+            u32 len = 0;
+            for (; str[len] && !strchr(" \t\r\n", str[len]) && (len < sizeof(label) - 1); len++)
+                label[len] = str[len];
+            label[len] = '\0';
+            checks += check_labels(script, size, label);
+            if (len > 1) {
+                label[1] = '*';
+                label[2] = '\0';
+                checks += check_labels(script, size, label);
+            }
+        }
+        char* line_end = strchr(ptr, '\n');
+        if (!line_end) break;
+        ptr = line_end + 1;
+    }
+    checks += check_labels(script, size, "no_such_label");
+
+    printf("%s: %lu checks\n", path, (unsigned long) checks);
+    host_free_index();
+    free(script);
+}
+
+static void run_case(const ScriptCase* tc, bool indexed) {
+    host_n_files = tc->n_files;
+    host_reset(tc->script);
+    if (!indexed) host_fail_malloc_at = 3; // index_lines(), the interpreter goes on without
+    bool result = ExecuteGM9Script(HOST_SCRIPT_PATH);
+    host_fail_malloc_at = 0;
+    CHECK(result == tc->result, "%s (%s): returned %d", tc->name, indexed ? "indexed" : "scanning", result);
+    CHECK(strcmp(host_log, tc->log) == 0, "%s (%s): output is \"%s\"", tc->name,
+        indexed ? "indexed" : "scanning", host_log);
+}
+
+int main(int argc, char** argv) {
+    for (int i = 1; i < argc; i++)
+        cross_check(argv[i]);
+
+    for (u32 i = 0; i < countof(cases); i++) {
+        run_case(cases + i, true);
+        run_case(cases + i, false);
+    }
+
+    // no memory for the NULL variable (4th allocation) -> the script doesn't start
+    host_reset("echo \"x\"\n");
+    host_fail_malloc_at = 4;
+    CHECK(!ExecuteGM9Script(HOST_SCRIPT_PATH), "script ran without its variables");
+    host_fail_malloc_at = 0;
+    CHECK(strcmp(host_log, "Out of memory.|") == 0, "output is \"%s\"", host_log);
+
+    return test_result("scripting_test");
+}
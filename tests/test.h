@@ -0,0 +1,37 @@
+#pragma once
+
+// tiny helpers shared by the host side tests (see Makefile)
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+static int test_failures = 0;
+
+#define CHECK(cond, ...) do { \
+    if (!(cond)) { \
+        test_failures++; \
+        printf("FAIL %s:%d: ", __FILE__, __LINE__); \
+        printf(__VA_ARGS__); \
+        printf("\n"); \
+    } \
+} while (0)
+
+// returns the exit code for main()
+static inline int test_result(const char* name) {
+    if (test_failures) printf("%s: %d check(s) failed\n", name, test_failures);
+    else printf("%s: ok\n", name);
+    return test_failures ? 1 : 0;
+}
+
+static inline double test_seconds(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + (ts.tv_nsec * 1e-9);
+}
+
+// deterministic pseudo random numbers, independent of the host libc
+static inline unsigned int test_rand(unsigned int* state) {
+    *state = (*state * 1103515245u) + 12345u;
+    return *state >> 1;
+}